@@ -3,13 +3,6 @@
         before you include this file when you need function implementation
 
         There is a example code at the end of the file 
-
-        TODO: 
-        1. Implement fen 
-        2. Implement move auditing
-        3. Move forward and backward (fen -> board -> fen)
-        4. Implement search algorithm
-        5. Read chess database
 */
 
 
@@ -18,6 +11,7 @@
 // typedefs for convience might need to exclude it later
 
 #include <assert.h>
+#include <stddef.h>
 #include <stdint.h>
 typedef uint32_t u32;
 typedef int32_t i32;
@@ -81,19 +75,99 @@ typedef struct glt_move glt_move;
 struct glt_move{
         glt_pos start, end;
         glt_move* next;
+        glt_piece promotion; /* piece a pawn promotes to, GLT_none for other moves */
 };
 
+/**
+        * A move packed in 16 bits, https://www.chessprogramming.org/Encoding_Moves
+        * bits 0 to 5 the start square, 6 to 11 the end square and 12 to 15 the glt_move_flag
+        * The squares are indexes, 0 is a1 and 63 is h8.
+        * It's what the move lists, the tt and the search use, glt_move is 12 times bigger
+*/
+typedef u16 glt_move16;
+
+/* a1a1 is never a move */
+#define GLT_MOVE16_NONE 0
+
+typedef enum {
+        GLT_move_quiet                  = 0,
+        GLT_move_double_push            = 1,
+        GLT_move_king_castle            = 2,
+        GLT_move_queen_castle           = 3,
+        GLT_move_capture                = 4,
+        GLT_move_en_passant             = 5,
+        GLT_move_knight_promotion       = 8,
+        GLT_move_bishop_promotion       = 9,
+        GLT_move_rook_promotion         = 10,
+        GLT_move_queen_promotion        = 11,
+        /* the promotions with GLT_move_capture set are captures that promote */
+        GLT_move_knight_promotion_capture = 12,
+        GLT_move_bishop_promotion_capture = 13,
+        GLT_move_rook_promotion_capture   = 14,
+        GLT_move_queen_promotion_capture  = 15,
+} glt_move_flag;
+
+#ifndef GLT_MAX_MOVES
+/* No legal chess position has more than 218 moves */
+#define GLT_MAX_MOVES 256
+#endif
+
+/**
+        * Fixed capacity move list that lives on the stack
+*/
+typedef struct {
+        glt_move16 moves[GLT_MAX_MOVES];
+        int count;
+} glt_move_list;
+
+/**
+         * Empties the move list
+ */
+GLT_CHESS_API inline void glt_move_list_clear(glt_move_list* list);
+
 /**
          * This is used to store the moves that has been played 
-         * The move in notation is stored to help revert the move
  */
 typedef struct glt_move_audit glt_move_audit;
 struct glt_move_audit{
         glt_pos start, end;
-        char str[10]; //move in notation
+        char str[10]; //move in notation, see glt_move16_to_san
         glt_move_audit* next;
 };
 
+/**
+         * Everything glt_make_move changes that can't be worked out from the move
+         * so glt_unmake_move can revert the move without a copy of the board
+ */
+typedef struct {
+        u64 hash;               /* board state before the move */
+        u64 checkers;
+        u32 flags;
+        u16 full_move_clock;
+        u8 half_move_clock;
+        i8 en_passant;
+        u8 from, to;            /* squares of the move */
+        glt_piece piece;        /* piece that moved, the pawn for promotions */
+        glt_piece captured;     /* GLT_none if nothing was captured */
+} glt_undo;
+
+#ifndef GLT_MAX_HISTORY
+/* How many moves glt_unmake_move can take back, has to be a power of two */
+#define GLT_MAX_HISTORY 256
+#endif
+
+/**
+         * Undo stack of the moves made on a board, it's a ring so only the last
+         * GLT_MAX_HISTORY moves can be taken back.
+         * It lives outside of the board so boards stay small and cheap to copy,
+         * see glt_board_set_history
+ */
+typedef struct {
+        glt_undo moves[GLT_MAX_HISTORY];
+        u16 top;   /* where the next move goes */
+        u16 count; /* how many moves can be taken back */
+} glt_history;
+
 
 /*
         * This represents coordinate in the board
@@ -128,16 +202,140 @@ typedef enum{
         glt_black_king_castle  = 1 << 4,
         glt_black_queen_castle = 1 << 5,
 }glt_flags;
+
+/**
+        * Color of a piece, used to index the per color bitboards
+*/
+typedef enum {
+        GLT_white = 0,
+        GLT_black = 1,
+} glt_color;
+
+/**
+        * The pieces array is the mailbox representation of the board.
+        * The bitboards are kept in sync with it, bit n of a set is board->pieces[n]
+        * so a set can be walked with glt_bb_pop_lsb instead of looping over squares.
+        *
+        * If you write into board->pieces directly call glt_board_sync_bitboards after
+*/
 typedef struct{
         glt_piece pieces[64];
         u32 flags;  
-        u8 half_move_clock, full_move_clock;
+        u8 half_move_clock;
+        u16 full_move_clock;
+        i8 en_passant;     /* index of the square behind a pawn that just moved two steps, -1 if none */
+
+        u64 bb_pieces[13]; /* one set per glt_piece, bb_pieces[GLT_none] is the empty squares */
+        u64 bb_color[2];   /* all the pieces of a glt_color */
+        u64 bb_occupied;   /* all the pieces on the board */
+
+        u64 hash;          /* zobrist key of the position, see glt_board_hash */
+        u64 checkers;      /* the pieces giving check to the side to move, see glt_board_checkers */
+
+        /* running sums of the evaluation, white minus black, see glt_evaluate */
+        i32 psq;           /* material and piece square score, middlegame in the high 16 bits and endgame in the low */
+        u8 phase;          /* 24 with all the pieces on the board, 0 with only kings and pawns */
+
+        /* undo stack of the moves made on the board, NULL if they can't be taken back, see glt_board_set_history */
+        glt_history* history;
 } glt_chess_board;
 
 GLT_CHESS_API int glt_pos_is_equal(glt_pos a, glt_pos b);
 GLT_CHESS_API int glt_piece_is_black(glt_piece piece);
 GLT_CHESS_API int glt_piece_is_white(glt_piece piece);
 
+/**
+         * Returns the color of the piece, GLT_none is treated as white
+         * so check for it before using the result
+ */
+GLT_CHESS_API inline glt_color glt_piece_color(glt_piece piece);
+
+/**
+         * Bitboard helpers
+         * glt_bb_popcount counts the squares in the set
+         * glt_bb_lsb returns the index of the lowest square in the set, set must not be empty
+         * glt_bb_pop_lsb removes the lowest square from the set and returns its index
+ */
+GLT_CHESS_API inline int glt_bb_popcount(u64 bb);
+GLT_CHESS_API inline int glt_bb_lsb(u64 bb);
+GLT_CHESS_API inline int glt_bb_pop_lsb(u64* bb);
+
+/**
+         * Returns the set with only the square of pos in it
+         * Positions outside of the board returns an empty set
+ */
+GLT_CHESS_API inline u64 glt_pos_to_bb(glt_pos pos);
+
+/**
+         * Fills the attack tables used by the generators
+         * glt_initilize_board and glt_board_sync_bitboards call it so you usually don't have to,
+         * it only does the work once but it isn't thread safe so call it before starting threads
+ */
+GLT_CHESS_API void glt_init_tables(void);
+
+/**
+         * Sliding piece attacks from the magic bitboard tables
+         * Returns every square the slider on the square (0 to 63) attacks given the occupied squares,
+         * the first piece on every ray is included so mask out your own pieces to get the moves
+         *
+         * Define GLT_CHESS_USE_PEXT to index the tables with the BMI2 pext instruction,
+         * without -mbmi2 it is picked at runtime and falls back to the magics on cpus without it
+ */
+GLT_CHESS_API inline u64 glt_rook_attacks(int square, u64 occupied);
+GLT_CHESS_API inline u64 glt_bishop_attacks(int square, u64 occupied);
+GLT_CHESS_API inline u64 glt_queen_attacks(int square, u64 occupied);
+
+/**
+         * Knight, king and pawn attacks from the precomputed tables
+         * Returns every square the piece on the square (0 to 63) attacks,
+         * pawn attacks are only the diagonal captures of a pawn of that color
+ */
+GLT_CHESS_API inline u64 glt_knight_attacks(int square);
+GLT_CHESS_API inline u64 glt_king_attacks(int square);
+GLT_CHESS_API inline u64 glt_pawn_attacks(glt_color color, int square);
+
+/**
+         * Attack queries, looked up from the square with the attack tables so nothing is generated
+         * glt_attackers_to returns the pieces of the color that attack the square (0 to 63)
+         * glt_is_square_attacked only tells if there is one
+         *
+         * glt_board_checkers returns the pieces giving check to the side to move,
+         * it's worked out by glt_make_move and kept in board->checkers
+ */
+GLT_CHESS_API inline u64 glt_attackers_to(glt_chess_board* board, int square, glt_color color);
+GLT_CHESS_API inline int glt_is_square_attacked(glt_chess_board* board, int square, glt_color color);
+GLT_CHESS_API inline u64 glt_board_checkers(glt_chess_board* board);
+GLT_CHESS_API inline int glt_in_check(glt_chess_board* board);
+
+/**
+         * Rebuilds all the bitboards from board->pieces
+         * Only needed when board->pieces was edited by hand
+ */
+GLT_CHESS_API void glt_board_sync_bitboards(glt_chess_board* board);
+
+/**
+         * Zobrist key of the position
+         * https://www.chessprogramming.org/Zobrist_Hashing
+         *
+         * It covers the pieces, the side to move, the castling rights and the en passant file.
+         * The key is kept in board->hash and updated with every glt_make_move and glt_unmake_move,
+         * glt_board_compute_hash computes it from scratch. The keys are the same in every run
+ */
+GLT_CHESS_API inline u64 glt_board_hash(glt_chess_board* board);
+GLT_CHESS_API u64 glt_board_compute_hash(glt_chess_board* board);
+
+/**
+         * Returns how many times the current position occured before in the history
+         * Only the positions since the last capture or pawn move are checked, always 0 without a history
+ */
+GLT_CHESS_API int glt_board_repetitions(glt_chess_board* board);
+
+/**
+         * Puts the piece at the pos and keeps the bitboards in sync
+         * Passing GLT_none clears the square
+ */
+GLT_CHESS_API void glt_board_set_piece(glt_chess_board* board, glt_pos pos, glt_piece piece);
+
 /**
          * Initilizes board to the start
          * Sets the active color to white
@@ -157,6 +355,11 @@ GLT_CHESS_API inline int glt_pos_to_index(glt_pos pos);
  */
 GLT_CHESS_API inline int glt_piece_at_pos(glt_chess_board* board, glt_pos pos);
 
+/**
+         * Returns the color that has to make the next move
+ */
+GLT_CHESS_API inline glt_color glt_active_color(glt_chess_board* board);
+
 /** 
          * Takes in a board state and returns if the piece is of same color as active color 
 */
@@ -174,13 +377,158 @@ GLT_CHESS_API inline int glt_pos_in_bounds(glt_pos pos) ;
 
 
 
+/* No fen is longer than this, the null at the end included */
+#define GLT_MAX_FEN_LENGTH 92
+
 /**
- * Returns the forsyth-edwards notation from the given board
+ * Writes the forsyth-edwards notation of the given board to fen
  * https://en.wikipedia.org/wiki/Forsyth%E2%80%93Edwards_Notation
+ *
+ * Only the bytes of the fen and the null at the end are written.
+ * Returns the length of the fen without the null, 0 if it doesn't fit in len.
+ * With len >= GLT_MAX_FEN_LENGTH it always fits and is written directly to fen
+*/
+GLT_CHESS_API int glt_get_fen_from_board(glt_chess_board *board, char* fen, int len);
+
+/**
+ * Writes the fens of count boards to out one after the other, each one ends with a new line
+ * Stops at the first fen that doesn't fit in capacity, returns the number of boards written
+ * and the number of bytes in bytes_written (no null is written at the end)
+*/
+GLT_CHESS_API int glt_get_fen_batch(glt_chess_board** boards, int count, char* out, size_t capacity, size_t* bytes_written);
+
+typedef enum {
+        GLT_fen_ok = 0,
+        GLT_fen_error_placement,     /* bad piece char, rank that isn't 8 squares, not 8 ranks */
+        GLT_fen_error_kings,         /* each side needs exactly one king */
+        GLT_fen_error_active_color,  /* has to be w or b */
+        GLT_fen_error_castling,      /* has to be - or some of KQkq */
+        GLT_fen_error_en_passant,    /* has to be - or a square on the 3rd or 6th rank */
+        GLT_fen_error_clock,         /* clocks have to be numbers that fit in the board */
+} glt_fen_error;
+
+/**
+ * Sets up the board from the forsyth-edwards notation
+ * Nothing is allocated, the board is written in place and the history is cleared.
+ * The two clocks are optional (they default to 0 and 1) and the fen can end with a
+ * space, a new line or a null, so lines of a position dump can be passed directly
+ *
+ * Returns GLT_fen_ok or the part of the fen that is wrong, the board is not usable after a error
+ * glt_fen_error_string describes the error
+*/
+GLT_CHESS_API glt_fen_error glt_set_board_from_fen(glt_chess_board *board, const char* fen);
+GLT_CHESS_API const char* glt_fen_error_string(glt_fen_error error);
+
+/**
+ * Fixed size binary position, 32 bytes against the 60 or so of a fen
+ * The bytes are the same on every platform so the files can be shared
+ *
+ * The pieces are stored in the order of the set bits of occupied (a1 first),
+ * there are at most 32 pieces on the board so they fit in 16 bytes of 4 bit codes.
+*/
+typedef struct {
+        u8 occupied[8];         /* bitboard of the occupied squares, little endian */
+        u8 pieces[16];          /* glt_piece of every occupied square, low nibble first */
+        u8 state;               /* bits 0 to 3 the castling rights, bit 4 set if black is to move */
+        u8 en_passant;          /* en passant square, 255 if there is none */
+        u8 half_move_clock;
+        u8 full_move_clock[2];  /* little endian */
+        u8 reserved[3];         /* 0, free for the user to tag the position (game result, score...) */
+} glt_packed_position;
+
+/**
+ * Packs the board, the history isn't stored
+*/
+GLT_CHESS_API void glt_pack_position(glt_chess_board* board, glt_packed_position* packed);
+
+/**
+ * Sets up the board from the packed position like glt_set_board_from_fen
+ * Returns 0 if the data isn't a position (no pieces past the 32nd, one king each, an en passant square
+ * behind a pawn that just moved two squares), the board is not usable then
+*/
+GLT_CHESS_API int glt_unpack_position(const glt_packed_position* packed, glt_chess_board* board);
+
+#ifndef GLT_CHESS_NO_STDIO
+#include <stdio.h>
 
- * Make sure that the string fen has enough memory allocated
+#ifndef GLT_PACKED_BLOCK_POSITIONS
+/* Positions per block of a packed file, 128KB */
+#define GLT_PACKED_BLOCK_POSITIONS 4096
+#endif
+
+/**
+ * Streaming reader and writer of packed position files
+ *
+ * The file is a list of blocks, every block is a 16 byte header followed by up to
+ * GLT_PACKED_BLOCK_POSITIONS positions:
+ *      4 bytes "GLTP"
+ *      1 byte version, GLT_PACKED_VERSION
+ *      3 bytes 0
+ *      4 bytes number of positions in the block, little endian
+ *      4 bytes checksum of the positions, little endian
+ * so a file can be appended to and a damaged block is detected by the reader.
+ *
+ *      glt_packed_writer writer;
+ *      glt_packed_writer_open(&writer, "positions.bin");
+ *      glt_packed_write(&writer, &board);
+ *      glt_packed_writer_close(&writer);
+ *
+ *      glt_packed_reader reader;
+ *      glt_packed_reader_open(&reader, "positions.bin");
+ *      while (glt_packed_read(&reader, &board)) ...
+ *      if (reader.error) ...
+ *      glt_packed_reader_close(&reader);
+*/
+#define GLT_PACKED_VERSION 1
+
+typedef struct {
+        FILE* file;
+        glt_packed_position* block;
+        u32 count;      /* positions waiting in block */
+        int error;      /* set if a write failed */
+} glt_packed_writer;
+
+typedef struct {
+        FILE* file;
+        glt_packed_position* block;
+        u32 count;      /* positions in block */
+        u32 next;       /* next position of block to return */
+        int error;      /* set if the file is damaged or a read failed, the reading stops at it */
+} glt_packed_reader;
+
+/**
+ * Opens the file for appending, returns 0 if it can't be opened or the block can't be allocated
+*/
+GLT_CHESS_API int glt_packed_writer_open(glt_packed_writer* writer, const char* path);
+
+/**
+ * Packs the board into the current block, full blocks are written to the file
+ * Returns 0 if a write failed
 */
-GLT_CHESS_API void glt_get_fen_from_board(glt_chess_board *board, char* fen, int len);
+GLT_CHESS_API int glt_packed_write(glt_packed_writer* writer, glt_chess_board* board);
+GLT_CHESS_API int glt_packed_write_packed(glt_packed_writer* writer, const glt_packed_position* packed);
+
+/**
+ * Writes the last block and closes the file, returns 0 if any write failed
+*/
+GLT_CHESS_API int glt_packed_writer_close(glt_packed_writer* writer);
+
+GLT_CHESS_API int glt_packed_reader_open(glt_packed_reader* reader, const char* path);
+
+/**
+ * Unpacks the next position to board, returns 0 at the end of the file or on a error
+*/
+GLT_CHESS_API int glt_packed_read(glt_packed_reader* reader, glt_chess_board* board);
+
+/**
+ * Returns the not yet read positions of the current block, or of the next one if it's all read,
+ * without copying or unpacking them. positions points into the reader and is valid until the next read.
+ * Returns 0 at the end of the file or on a error
+*/
+GLT_CHESS_API u32 glt_packed_read_block(glt_packed_reader* reader, const glt_packed_position** positions);
+
+GLT_CHESS_API void glt_packed_reader_close(glt_packed_reader* reader);
+#endif
 
 
 /**
@@ -242,632 +590,5130 @@ GLT_CHESS_API glt_move* glt_generate_queen_moves(glt_chess_board* board, glt_pos
 GLT_CHESS_API glt_move* glt_generate_moves(glt_chess_board * board, glt_pos pos);
 
 /**
-        * Take in a glt_move and make that move
-        * Let the user code handle iterating over the possible moves
-        * It'll make our api simpler
-        * TODO: don't make illigal moves
+        * Same as the generators above but the moves are appended to a caller provided
+        * move list instead of a malloc'd linked list, nothing is allocated and nothing has to be freed.
+        * The list is not cleared so moves of multiple pieces can be collected in one list.
+        * Returns the number of moves that were added
+        *
+        *       glt_move_list list;
+        *       glt_move_list_clear(&list);
+        *       glt_generate_moves_list(&board, pos, &list);
+        *       for (int i = 0; i < list.count; ++i) glt_make_move16(&copy, list.moves[i]);
 */
-GLT_CHESS_API int glt_make_move(glt_chess_board* board, glt_move move);
-        
-#ifdef GLT_CHESS_IMPLEMENTATION
-
-#ifndef GLT_malloc
-#include <stdlib.h>
-#define GLT_malloc(x) (malloc(x))
-#define GLT_free(x) (free(x))
-#endif
-/* Bit operations for accessing and manipulating flags */
-static inline int glt__is_flag_set(u32 flags, glt_flags flag){
-        return (flag & flags) > 0;
-}
+GLT_CHESS_API int glt_generate_white_pawn_moves_list(glt_chess_board* board, glt_pos start, glt_move_list* list);
+GLT_CHESS_API int glt_generate_black_pawn_moves_list(glt_chess_board* board, glt_pos start, glt_move_list* list);
+GLT_CHESS_API int glt_generate_knight_moves_list(glt_chess_board* board, glt_pos start, glt_move_list* list);
+GLT_CHESS_API int glt_generate_rook_moves_list(glt_chess_board* board, glt_pos start, glt_move_list* list);
+GLT_CHESS_API int glt_generate_bishop_moves_list(glt_chess_board* board, glt_pos start, glt_move_list* list);
+GLT_CHESS_API int glt_generate_king_moves_list(glt_chess_board* board, glt_pos start, glt_move_list* list);
+GLT_CHESS_API int glt_generate_queen_moves_list(glt_chess_board* board, glt_pos start, glt_move_list* list);
+GLT_CHESS_API int glt_generate_moves_list(glt_chess_board* board, glt_pos pos, glt_move_list* list);
 
-static inline void glt__flag_set(u32 *flags, glt_flags flag){
-        *flags |= flag;
-}
+/**
+        * Generates the moves of every piece of the active color in one pass over the pieces on the board
+        * glt_generate_captures only returns the moves that capture something (en passant included)
+        * glt_generate_quiets returns the rest, together they are the same as glt_generate_all_moves
+        * The flags of the moves are set, the promotions that capture are captures
+        * 
+        * The moves are pseudo legal, they can leave the king in check.
+        * Castling is only generated when the king doesn't castle out of, thru or into check
+        * Appends to the list and returns the number of moves that were added
+*/
+GLT_CHESS_API int glt_generate_all_moves(glt_chess_board* board, glt_move_list* list);
+GLT_CHESS_API int glt_generate_captures(glt_chess_board* board, glt_move_list* list);
+GLT_CHESS_API int glt_generate_quiets(glt_chess_board* board, glt_move_list* list);
 
-static inline void glt__clear_flag(u32 *flags, glt_flags flag){
-        *flags &= ~flag;
-}
-static inline void glt__flip_flag(u32 *flags, glt_flags flag){
-        *flags ^= flag;
-}
+/**
+        * Same as the generators above but only the legal moves are returned
+        * The pinned pieces and the squares that stop a check are worked out once for the position
+        * so the moves don't have to be made to find out if they leave the king in check.
+        * In double check only the king moves. The list is empty in checkmate and stalemate
+*/
+GLT_CHESS_API int glt_generate_legal_moves(glt_chess_board* board, glt_move_list* list);
+GLT_CHESS_API int glt_generate_legal_captures(glt_chess_board* board, glt_move_list* list);
+GLT_CHESS_API int glt_generate_legal_quiets(glt_chess_board* board, glt_move_list* list);
 
-static int glt_pos_is_equal(glt_pos a, glt_pos b)
-{
-        return (a.x == b.x) && ( a.y == b.y);
-}
+/**
+        * Frees the linked list returned by the generators and sets the head to NULL
+*/
+GLT_CHESS_API void glt_moves_delte(glt_move** head_ptr);
 
-static int glt_piece_is_black(glt_piece piece)
-{
-        return (int)piece > 6;
-}
+/**
+        * Same as glt_moves_delte but for the move audit list
+*/
+GLT_CHESS_API void glt_move_audits_delte(glt_move_audit** head_ptr);
 
-static int glt_piece_is_white(glt_piece piece)
-{
-        return (int)piece <= 6 &&  (int)piece >=1;
-}
+/**
+        * Bump allocator for the glt_move and glt_move_audit nodes
+        *
+        * When a arena is bound to a thread with glt_arena_bind every node that thread
+        * allocates comes from the arena instead of GLT_malloc. The nodes don't have to be
+        * freed one by one, glt_arena_reset drops all of them at once in O(1).
+        * glt_moves_delte still works on them, it skips the nodes that came from an arena whatever
+        * arena is bound when it's called (every node has a small header saying where it's from).
+        * A list with arena nodes has to be deleted before its arena is reset or destroyed, or not
+        * at all, debug builds assert on nodes that aren't live.
+        * If the arena runs out of memory the nodes fall back to GLT_malloc.
+        *
+        * Arenas are not thread safe, give every thread it's own arena
+        *
+        *       glt_arena arena;
+        *       glt_arena_create(&arena, 1 << 20);
+        *       glt_arena_bind(&arena);
+        *       ... generate moves, don't bother deleting them ...
+        *       glt_arena_reset(&arena);
+        *       glt_arena_bind(NULL);
+        *       glt_arena_destroy(&arena);
+*/
+typedef struct {
+        u8* base;
+        size_t capacity, used;
+        int owns_memory;
+} glt_arena;
 
-static inline int glt_pos_to_index(glt_pos pos){
-        return (pos.y-1) * 8 + (pos.x -1);
-}
+/** 
+         * Uses the caller provided memory for the arena, nothing is allocated 
+ */
+GLT_CHESS_API void glt_arena_init(glt_arena* arena, void* memory, size_t capacity);
 
-//index starts from 0 and ends at 63
-static inline glt_pos glt_index_to_pos(int index){
-        glt_pos ret;
-        ret.x = (index % 8) + 1;
-        ret.y = (index / 8) + 1;
-        return ret;
-}
+/** 
+         * Allocates capacity bytes with GLT_malloc for the arena
+         * Returns 0 if it fails to allocate
+ */
+GLT_CHESS_API int glt_arena_create(glt_arena* arena, size_t capacity);
 
-/* Get in the piece at the pos */
-static inline int glt_piece_at_pos(glt_chess_board* board, glt_pos pos)
-{
-        return board->pieces[glt_pos_to_index(pos)];
-}
+/** 
+         * Frees the memory allocated by glt_arena_create 
+ */
+GLT_CHESS_API void glt_arena_destroy(glt_arena* arena);
 
+/** 
+         * Returns size bytes from the arena or NULL if it's full 
+ */
+GLT_CHESS_API void* glt_arena_alloc(glt_arena* arena, size_t size);
 
-static inline int glt_piece_is_active_color(glt_chess_board* board, glt_piece piece)
-{
-        if (piece == GLT_none) return 1;
-        else if (glt_piece_is_black(piece) && 
-                !glt__is_flag_set(board->flags, glt_flag_active_color)) return 1;
-        else if (glt_piece_is_white(piece) &&
-                glt__is_flag_set(board->flags, glt_flag_active_color)) return 1;
+/** 
+         * Drops everything allocated from the arena 
+ */
+GLT_CHESS_API inline void glt_arena_reset(glt_arena* arena);
 
-        return 0;
+/** 
+         * Makes the calling thread allocate nodes from the arena, NULL goes back to GLT_malloc
+         * Returns the arena that was bound before
+ */
+GLT_CHESS_API glt_arena* glt_arena_bind(glt_arena* arena);
 
-}
+/**
+        * Take in a glt_move and make that move
+        * Let the user code handle iterating over the possible moves
+        * It'll make our api simpler
+        * 
+        * A king moving two squares castles, a pawn moving to board->en_passant captures en passant
+        * and a pawn reaching the last rank promotes to move.promotion (a queen if it's GLT_none).
+        * The castling rights, en passant square and clocks are updated
+        * Returns 0 and leaves the board as it was if the move isn't legal
+*/
+GLT_CHESS_API int glt_make_move(glt_chess_board* board, glt_move move);
 
-static inline int glt_pieces_is_same_color(glt_piece a, glt_piece b){
-        if (a == GLT_none || b == GLT_none) return 0;
-        else if(glt_piece_is_black(a) && glt_piece_is_black(b)) return 1;
-        else if(glt_piece_is_white(a) && glt_piece_is_white(b)) return 1;
-        return 0;
-}
+/**
+        * Same as glt_make_move for the moves of the move lists, without the legality test
+        * Only GLT_MOVE16_NONE and a start square without a piece of the active color are turned down.
+        * The move isn't checked against the moves of the piece or for leaving the king in check, so
+        * only pass moves generated for this position (use glt_make_move for anything else).
+        * The flags aren't read, castling and en passant are worked out from the squares like
+        * glt_make_move does, only the promotion piece comes from them
+*/
+GLT_CHESS_API int glt_make_move16(glt_chess_board* board, glt_move16 move);
 
-static inline int glt_pos_in_bounds(glt_pos pos) {
-  return !((pos.x > 8 || pos.x <= 0) || (pos.y > 8 || pos.y <= 0));
-}
+/**
+        * Gives the board an undo stack and clears it, the moves made after this can be taken back with
+        * glt_unmake_move and count for glt_board_repetitions. NULL takes the stack away again.
+        *
+        * glt_initilize_board, glt_set_board_from_fen and glt_unpack_position leave the board without
+        * one. A copy of a board points to the same stack, give the copy its own before making moves on it
+        *
+        *       glt_history history;
+        *       glt_set_board_from_fen(&board, fen);
+        *       glt_board_set_history(&board, &history);
+*/
+GLT_CHESS_API void glt_board_set_history(glt_chess_board* board, glt_history* history);
 
-static inline glt_pos glt_coord_to_pos(glt_coord coord){
-        glt_pos ret = { (int)coord.file - 64,  coord.rank};
-        return ret;
-}
+/**
+        * Takes back the last move made with glt_make_move
+        * Returns 0 if there is no move to take back or the board has no history
+        *
+        *       for (int i = 0; i < list.count; ++i) {
+        *               glt_make_move16(&board, list.moves[i]);
+        *               ... search the position ...
+        *               glt_unmake_move(&board);
+        *       }
+*/
+GLT_CHESS_API int glt_unmake_move(glt_chess_board* board);
 
-static inline glt_coord glt_pos_to_coord(glt_pos pos){
-        glt_coord ret = { 64 + (int)pos.x ,  pos.y};
-        return ret;
-}
+/**
+        * Returns the undo record of the move that was made n moves ago, 0 is the last move
+        * NULL if it's no longer in the history or the board has no history
+*/
+GLT_CHESS_API const glt_undo* glt_board_history(glt_chess_board* board, int n);
 
+/**
+        * Writes the move in coordinate notation (e2e4, e7e8q) to str and returns the length
+        * str needs to have space for 6 chars, the string is null terminated
+*/
+GLT_CHESS_API int glt_move_to_string(glt_move move, char* str);
+GLT_CHESS_API int glt_move16_to_string(glt_move16 move, char* str);
 
+/**
+        * Packing and unpacking glt_move16, flags is a glt_move_flag
+*/
+GLT_CHESS_API inline glt_move16 glt_move16_encode(int from, int to, int flags);
+GLT_CHESS_API inline int glt_move16_from(glt_move16 move);
+GLT_CHESS_API inline int glt_move16_to(glt_move16 move);
+GLT_CHESS_API inline int glt_move16_flags(glt_move16 move);
+GLT_CHESS_API inline int glt_move16_is_capture(glt_move16 move);
+GLT_CHESS_API inline int glt_move16_is_promotion(glt_move16 move);
+GLT_CHESS_API inline int glt_move16_is_castle(glt_move16 move);
 
-static void glt_initilize_board(glt_chess_board* board){
-        board->pieces[0] = GLT_white_rook;
-        board->pieces[1] = GLT_white_knight;
-        board->pieces[2] = GLT_white_bishop;
-        board->pieces[3] = GLT_white_queen;
-        board->pieces[4] = GLT_white_king;
-        board->pieces[5] = GLT_white_bishop;
-        board->pieces[6] = GLT_white_knight;
-        board->pieces[7] = GLT_white_rook;
+/**
+        * The piece of the color the move promotes to, GLT_none if it isn't a promotion
+*/
+GLT_CHESS_API inline glt_piece glt_move16_promotion(glt_move16 move, glt_color color);
+
+/**
+        * Conversions between glt_move16 and glt_move or glt_coord
+        * The board is needed to work out the flags, pass it before the move is made.
+        * glt_move16_to_move colors the promotion by the rank the pawn promotes on
+*/
+GLT_CHESS_API glt_move glt_move16_to_move(glt_move16 move);
+GLT_CHESS_API glt_move16 glt_move_to_move16(glt_chess_board* board, glt_move move);
+GLT_CHESS_API glt_move16 glt_coords_to_move16(glt_chess_board* board, glt_coord start, glt_coord end, glt_piece promotion);
+GLT_CHESS_API void glt_move16_to_coords(glt_move16 move, glt_coord* start, glt_coord* end);
+
+/**
+        * Standard algebraic notation (Nbd7, exd6, O-O, e8=Q+) of the moves of the side to move
+        * https://en.wikipedia.org/wiki/Algebraic_notation_(chess)
+        *
+        * glt_move16_to_san writes the move to str and returns the length, str needs space for 8 chars.
+        * The move has to be legal, the board is left as it was.
+        *
+        * glt_move16_from_san parses the move, san doesn't have to be null terminated and
+        * check and annotation marks at the end are ignored.
+        * Returns GLT_MOVE16_NONE if it isn't a legal move or it's ambiguous
+        *
+        * Neither generates the moves, the pieces that can move to the square are found from the square
+*/
+GLT_CHESS_API int glt_move16_to_san(glt_chess_board* board, glt_move16 move, char* str);
+GLT_CHESS_API glt_move16 glt_move16_from_san(glt_chess_board* board, const char* san, size_t length);
+
+/**
+        * Counts the leaf nodes of the legal move tree depth plies deep
+        * https://www.chessprogramming.org/Perft
+        *
+        * This is the regression test for the move generator, the counts of the well known
+        * positions are in tests/glt_chess_perft.c
+*/
+GLT_CHESS_API u64 glt_perft(glt_chess_board* board, int depth);
+
+/**
+        * Same as glt_perft but the count is split by the root moves
+        * moves gets the legal root moves and counts[i] the nodes under moves->moves[i],
+        * counts needs space for GLT_MAX_MOVES entries. Returns the total
+*/
+GLT_CHESS_API u64 glt_perft_divide(glt_chess_board* board, int depth, glt_move_list* moves, u64* counts);
+
+typedef struct {
+        u64 key;        /* hash and depth of the position xor count */
+        u64 count;
+} glt__perft_slot;
+
+/* Hash table of subtree counts, it can be shared by the threads of glt_perft_parallel */
+typedef struct {
+        glt__perft_slot* slots;
+        u64 slot_count;         /* power of 2 */
+} glt_perft_cache;
+
+/**
+        * Allocates a cache using at most megabytes of memory, returns 0 if the allocation fails
+*/
+GLT_CHESS_API int glt_perft_cache_create(glt_perft_cache* cache, size_t megabytes);
+GLT_CHESS_API void glt_perft_cache_destroy(glt_perft_cache* cache);
+GLT_CHESS_API void glt_perft_cache_clear(glt_perft_cache* cache);
+
+/**
+        * Same count as glt_perft but split over threads
+        *
+        * The moves of the first two plies are the tasks, every thread gets a range of them
+        * and steals from the ranges of the others when it runs out. Each thread has its own
+        * board and writes the counts to its own tasks so nothing is locked.
+        * threads <= 0 uses glt_thread_count(). cache can be NULL, with a cache the counts of
+        * the subtrees are looked up by glt_board_hash and depth, a hash collision can make
+        * the count wrong so leave it out for the regression tests.
+        * With GLT_CHESS_NO_THREADS it runs the tasks on the calling thread
+*/
+GLT_CHESS_API u64 glt_perft_parallel(glt_chess_board* board, int depth, int threads, glt_perft_cache* cache);
+
+/**
+        * Transposition table, a fixed size hash table of search results keyed by glt_board_hash
+        * https://www.chessprogramming.org/Transposition_Table
+        *
+        * The table is split in 64 byte buckets (one cache line) of 4 entries.
+        * It's lockless so any number of search threads can share one table, every entry
+        * stores the key xor'ed with the data so a entry torn by two threads writing at the same
+        * time doesn't match the key anymore and is treated as a miss
+        *
+        *       glt_tt tt;
+        *       glt_tt_create(&tt, 64);
+        *       glt_tt_entry entry;
+        *       if (glt_tt_probe(&tt, glt_board_hash(&board), &entry) && entry.depth >= depth) ...
+        *       glt_tt_store(&tt, glt_board_hash(&board), best, score, depth, GLT_bound_exact);
+        *       glt_tt_destroy(&tt);
+*/
+typedef enum {
+        GLT_bound_none  = 0,
+        GLT_bound_upper = 1, /* the score is at most entry.score (fail low) */
+        GLT_bound_lower = 2, /* the score is at least entry.score (fail high) */
+        GLT_bound_exact = 3,
+} glt_bound;
+
+/* A entry read from the table */
+typedef struct {
+        glt_move16 move; /* best move, GLT_MOVE16_NONE if there is none */
+        i16 score;
+        u8 depth;
+        u8 bound;       /* glt_bound */
+} glt_tt_entry;
+
+typedef struct {
+        u64 key;  /* hash ^ data */
+        u64 data;
+} glt__tt_slot;
+
+#define GLT_TT_BUCKET_SIZE 4
+
+typedef struct {
+        glt__tt_slot slots[GLT_TT_BUCKET_SIZE];
+} glt__tt_bucket;
+
+typedef struct {
+        glt__tt_bucket* buckets;  /* cache line aligned */
+        void* memory;
+        u64 bucket_count;         /* power of two */
+        u8 generation;
+} glt_tt;
+
+/**
+        * Allocates the table with GLT_malloc, the size is rounded down to a power of two
+        * Returns 0 if it fails to allocate
+*/
+GLT_CHESS_API int glt_tt_create(glt_tt* tt, size_t megabytes);
+GLT_CHESS_API void glt_tt_destroy(glt_tt* tt);
+
+/**
+        * Empties the table, don't call it while threads are using the table
+*/
+GLT_CHESS_API void glt_tt_clear(glt_tt* tt);
+
+/**
+        * Call it when a new search starts, entries of older searches are replaced first
+*/
+GLT_CHESS_API void glt_tt_new_search(glt_tt* tt);
+
+/**
+        * Looks up the hash, returns 1 and fills in entry if it's in the table
+*/
+GLT_CHESS_API int glt_tt_probe(glt_tt* tt, u64 hash, glt_tt_entry* entry);
+
+/**
+        * Stores a search result, depth has to be between 0 and 255
+        * The bucket keeps the deeper and newer results
+*/
+GLT_CHESS_API void glt_tt_store(glt_tt* tt, u64 hash, glt_move16 move, int score, int depth, glt_bound bound);
+
+/**
+        * How full the table is in permill, only the entries of the current search are counted
+        * It looks at the first 1000 entries so it's cheap enough to call while searching
+*/
+GLT_CHESS_API int glt_tt_hashfull(glt_tt* tt);
+
+/**
+        * Static evaluation of the board in centipawns from the side to move's view
+        *
+        * Material and piece square tables with a middlegame and an endgame score mixed by the
+        * material left on the board, https://www.chessprogramming.org/Tapered_Eval
+        * The sums are kept in the board by every move so this doesn't look at the pieces
+*/
+GLT_CHESS_API int glt_evaluate(glt_chess_board* board);
+
+/**
+        * Static exchange evaluation, https://www.chessprogramming.org/Static_Exchange_Evaluation
+        * What the side to move wins (or loses when it's negative) in centipawns if both sides keep
+        * capturing on the square of the move with their least valuable piece for as long as it pays.
+        * The sliders behind the pieces that capture join in. Quiet moves are scored as the exchange
+        * that follows when the piece gets taken
+*/
+GLT_CHESS_API int glt_see(glt_chess_board* board, glt_move16 move);
+
+#ifndef GLT_MAX_PLY
+/* Deepest the search goes, also the longest principal variation */
+#define GLT_MAX_PLY 128
+#endif
+
+/* Scores above GLT_MATE_SCORE - GLT_MAX_PLY are mates, GLT_MATE_SCORE - score is the plies to mate */
+#define GLT_MATE_SCORE 32000
+#define GLT_INFINITE_SCORE 32001
+
+/**
+        * Limits of a search, a 0 means no limit.
+        * Without any limit the search goes to GLT_MAX_PLY so set at least one of them
+        * The search always completes depth 1 so there is a move to play
+*/
+typedef struct {
+        int depth;
+        u64 nodes;
+        u64 time_ms;
+        glt_tt* tt;     /* transposition table to use, can be NULL */
+        int threads;    /* threads searching together, 0 or 1 searches on the calling thread only */
+} glt_search_limits;
+
+typedef struct {
+        glt_move16 best_move; /* GLT_MOVE16_NONE if there is no legal move */
+        int score;            /* centipawns from the side to move's view, see GLT_MATE_SCORE */
+        int depth;            /* last depth that was completed */
+        glt_move16 pv[GLT_MAX_PLY];
+        int pv_length;
+        u64 nodes;
+        u64 time_ms;
+        u64 nps;
+} glt_search_result;
+
+/**
+        * Negamax alpha beta search with iterative deepening and aspiration windows
+        * https://www.chessprogramming.org/Alpha-Beta
+        * At the end of the depth it searches the captures that don't lose material until the position is quiet
+        *
+        * The board is searched in place with glt_make_move and glt_unmake_move and is
+        * the same as before when it returns. Give it a history (glt_board_set_history) with the
+        * moves of the game so the search sees repetitions, without one it uses its own
+        *
+        * With limits.threads > 1 it runs a Lazy SMP search, https://www.chessprogramming.org/Lazy_SMP
+        * The helper threads search their own copy of the board and only share the tt with
+        * the calling thread, so give it a tt or the helpers are wasted work.
+        * The calling thread checks the limits, the node limit only counts its own nodes,
+        * and stops and joins the helpers before returning. The result is from the thread
+        * that completed the deepest iteration and nodes counts every thread.
+        * Define GLT_CHESS_NO_THREADS to build without threads, limits.threads is ignored then
+        *
+        *       glt_search_limits limits = {0};
+        *       glt_search_result result;
+        *       limits.time_ms = 1000;
+        *       glt_search(&board, &limits, &result);
+        *       if (result.best_move != GLT_MOVE16_NONE) glt_make_move16(&board, result.best_move);
+*/
+GLT_CHESS_API void glt_search(glt_chess_board* board, const glt_search_limits* limits, glt_search_result* result);
+
+/**
+        * Number of hardware threads, a good limits.threads to use every core
+        * Always 1 with GLT_CHESS_NO_THREADS
+*/
+GLT_CHESS_API int glt_thread_count(void);
+
+/* A piece of a string that isn't null terminated, it points into the text it was read from */
+typedef struct {
+        const char* data;
+        size_t length;
+} glt_view;
+
+/**
+ * PGN database reader, https://www.chessprogramming.org/Portable_Game_Notation
+ *
+ * Nothing is copied, the games, tags and moves are views into the text. The text is usually
+ * a file mapped with glt_pgn_open so the OS pages it in as the reader goes.
+ *
+ *      glt_pgn_file file;
+ *      glt_pgn_reader reader;
+ *      glt_pgn_game game;
+ *      glt_pgn_open(&file, "games.pgn");
+ *      glt_pgn_reader_init(&reader, file.data, file.size);
+ *      while (glt_pgn_next_game(&reader, &game)) {
+ *              glt_view white;
+ *              if (glt_pgn_find_tag(&game, "White", &white)) ...
+ *              glt_pgn_play(&game, &board, on_position, user);
+ *      }
+ *      glt_pgn_close(&file);
+ *
+ * To read with several threads glt_pgn_split the text and give every thread a reader of its part
+*/
+typedef struct {
+        glt_view text;          /* all of the game */
+        glt_view tags;          /* the tag pairs section, walk it with glt_pgn_next_tag */
+        glt_view movetext;      /* the moves, comments and result, walk it with glt_pgn_next_san */
+} glt_pgn_game;
+
+typedef struct {
+        glt_view name;
+        glt_view value;         /* without the quotes, escaped quotes and backslashes are left as they are */
+} glt_pgn_tag;
+
+typedef struct {
+        const char* cursor;
+        const char* end;
+} glt_pgn_reader;
+
+GLT_CHESS_API void glt_pgn_reader_init(glt_pgn_reader* reader, const char* data, size_t size);
+
+/**
+        * Finds the next game, returns 0 when there are no more games
+*/
+GLT_CHESS_API int glt_pgn_next_game(glt_pgn_reader* reader, glt_pgn_game* game);
+
+/**
+        * Reads the tag at the start of cursor and moves cursor past it, returns 0 if there are no more tags
+        *
+        *       glt_view cursor = game.tags;
+        *       glt_pgn_tag tag;
+        *       while (glt_pgn_next_tag(&cursor, &tag)) ...
+*/
+GLT_CHESS_API int glt_pgn_next_tag(glt_view* cursor, glt_pgn_tag* tag);
+
+/**
+        * Looks up the value of the tag called name, returns 0 if the game doesn't have it
+*/
+GLT_CHESS_API int glt_pgn_find_tag(const glt_pgn_game* game, const char* name, glt_view* value);
+
+/**
+        * Reads the next move of the movetext at cursor and moves cursor past it
+        * Move numbers, comments, variations and NAGs are skipped.
+        * Returns 0 at the result or the end of the movetext
+*/
+GLT_CHESS_API int glt_pgn_next_san(glt_view* cursor, glt_view* san);
+
+/**
+        * Called for every move of the game with the position before the move, return 0 to stop
+*/
+typedef int (*glt_pgn_move_fn)(glt_chess_board* board, glt_move16 move, void* user);
+
+/**
+        * Plays the game on the board from the start position or the FEN tag
+        * callback can be NULL, then the board just ends up at the last position
+        * Returns the number of moves played or -1 if the FEN or a move isn't valid
+*/
+GLT_CHESS_API int glt_pgn_play(const glt_pgn_game* game, glt_chess_board* board, glt_pgn_move_fn callback, void* user);
+
+/**
+        * Splits the text in parts that start at a game, offsets gets parts + 1 offsets so part i is
+        * from offsets[i] to offsets[i + 1]. Parts can be empty if there are fewer games than parts
+*/
+GLT_CHESS_API void glt_pgn_split(const char* data, size_t size, int parts, size_t* offsets);
+
+#ifndef GLT_CHESS_NO_STDIO
+typedef struct {
+        const char* data;
+        size_t size;
+        void* handle;   /* what the platform needs to unmap the file */
+} glt_pgn_file;
+
+/**
+        * Maps the file in memory, define GLT_CHESS_NO_MMAP to read it all into memory instead
+        * Returns 0 if it can't be opened
+*/
+GLT_CHESS_API int glt_pgn_open(glt_pgn_file* file, const char* path);
+GLT_CHESS_API void glt_pgn_close(glt_pgn_file* file);
+#endif
+
+/**
+        * Instrumentation, define GLT_CHESS_INSTRUMENT before including the implementation to turn it on
+        * Without it the hooks compile to nothing and the stats are always 0.
+        *
+        * The counters and timers are per thread, nothing is shared between the threads so the hot
+        * paths don't pay for atomics. The threads of glt_search and glt_perft_parallel add their stats
+        * to the calling thread when they are joined, your own threads have to snapshot and merge them
+*/
+typedef enum {
+        GLT_counter_moves_generated = 0,  /* moves written by the generators */
+        GLT_counter_node_allocs,          /* linked list nodes, glt__move_append and the audits */
+        GLT_counter_node_mallocs,         /* the nodes that didn't fit in an arena and went to GLT_malloc */
+        GLT_counter_illegal_moves,        /* moves of a piece of the side to move that glt_make_move turned down */
+        GLT_counter_search_nodes,         /* nodes of the alpha beta search */
+        GLT_counter_quiescence_nodes,     /* nodes of the quiescence search */
+        GLT_counter_tt_hits,              /* tt probes of the search that found the position */
+        GLT_counter_beta_cutoffs,         /* nodes of the search that failed high */
+        GLT_counter_count,
+} glt_counter;
+
+/**
+        * The timers count calls and cycles (or milliseconds where there is no cycle counter).
+        * They are inclusive, glt_timer_generate_legal has the time of the glt_timer_generate_* it calls
+*/
+typedef enum {
+        GLT_timer_generate_pawn = 0,      /* glt_generate_white/black_pawn_moves(_list) */
+        GLT_timer_generate_knight,
+        GLT_timer_generate_bishop,
+        GLT_timer_generate_rook,
+        GLT_timer_generate_queen,
+        GLT_timer_generate_king,
+        GLT_timer_generate_position,      /* glt_generate_all_moves, glt_generate_captures, glt_generate_quiets */
+        GLT_timer_generate_legal,         /* glt_generate_legal_moves, _captures, _quiets */
+        GLT_timer_make_move,              /* every move made, glt_make_move, glt_make_move16 and the search */
+        GLT_timer_unmake_move,
+        GLT_timer_fen_parse,
+        GLT_timer_fen_write,
+        GLT_timer_search,                 /* glt_search on the calling thread */
+        GLT_timer_quiescence,             /* the quiescence searches at the leaves of the search */
+        GLT_timer_pick_captures,          /* the capture stage of the move picker, generating and scoring */
+        GLT_timer_pick_quiets,            /* the quiet stage of the move picker, generating and scoring */
+        GLT_timer_see,
+        GLT_timer_count,
+} glt_timer;
+
+typedef struct {
+        u64 counters[GLT_counter_count];
+        u64 calls[GLT_timer_count];
+        u64 cycles[GLT_timer_count];
+} glt_instrument_stats;
+
+/**
+        * Copies the stats of the calling thread
+*/
+GLT_CHESS_API void glt_instrument_snapshot(glt_instrument_stats* stats);
+
+/**
+        * Sets the stats of the calling thread to 0
+*/
+GLT_CHESS_API void glt_instrument_reset(void);
+
+/**
+        * Adds the stats of from to into, to sum up the snapshots of several threads
+*/
+GLT_CHESS_API void glt_instrument_merge(glt_instrument_stats* into, const glt_instrument_stats* from);
+
+/**
+        * Names of the counters and timers as they are written by glt_instrument_write
+*/
+GLT_CHESS_API const char* glt_counter_name(glt_counter counter);
+GLT_CHESS_API const char* glt_timer_name(glt_timer timer);
+
+#ifndef GLT_CHESS_NO_STDIO
+#include <stdio.h>
+
+/**
+        * Writes the stats to the file as text, a line per counter and timer, or as one line of json
+        *       {"counters":{"moves_generated":...},"timers":{"make_move":{"calls":...,"cycles":...},...}}
+*/
+GLT_CHESS_API void glt_instrument_write(const glt_instrument_stats* stats, FILE* file, int json);
+#endif
+
+#ifdef GLT_CHESS_IMPLEMENTATION
+
+#include <string.h>
+
+#ifndef GLT_malloc
+#include <stdlib.h>
+#define GLT_malloc(x) (malloc(x))
+#define GLT_free(x) (free(x))
+#endif
+
+/* Milliseconds from a monotonic clock, define it before including to use your own clock */
+#ifndef GLT_time_ms
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#define GLT_time_ms() ((u64)GetTickCount64())
+#else
+#include <time.h>
+#if defined(CLOCK_MONOTONIC)
+static inline u64 glt__time_ms(void)
+{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (u64)ts.tv_sec * 1000 + (u64)ts.tv_nsec / 1000000;
+}
+#else
+/* without posix fall back to the processor time */
+static inline u64 glt__time_ms(void)
+{
+        return (u64)clock() * 1000 / CLOCKS_PER_SEC;
+}
+#endif
+#define GLT_time_ms() glt__time_ms()
+#endif
+#endif
+
+#if defined(__cplusplus) && __cplusplus >= 201103L
+#define GLT_THREAD_LOCAL thread_local
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define GLT_THREAD_LOCAL _Thread_local
+#elif defined(_MSC_VER)
+#define GLT_THREAD_LOCAL __declspec(thread)
+#else
+#define GLT_THREAD_LOCAL __thread
+#endif
+
+#ifdef GLT_CHESS_INSTRUMENT
+/* Cycle counter of the instrumentation timers, define it before including to use your own counter */
+#ifndef GLT_cycles
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define GLT_cycles() ((u64)__rdtsc())
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define GLT_cycles() ((u64)__rdtsc())
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+static inline u64 glt__cycles(void)
+{
+        u64 ticks;
+        __asm__ volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+        return ticks;
+}
+#define GLT_cycles() glt__cycles()
+#else
+/* no cycle counter, the timers count milliseconds */
+#define GLT_cycles() GLT_time_ms()
+#endif
+#endif
+
+static GLT_THREAD_LOCAL glt_instrument_stats glt__instrument;
+
+#define GLT__COUNT(counter, n) (glt__instrument.counters[counter] += (u64)(n))
+#define GLT__TIMER_START(timer) u64 glt__timer_start_##timer = GLT_cycles()
+#define GLT__TIMER_STOP(timer) (glt__instrument.calls[timer]++, \
+                                glt__instrument.cycles[timer] += GLT_cycles() - glt__timer_start_##timer)
+#else
+#define GLT__COUNT(counter, n) ((void)0)
+#define GLT__TIMER_START(timer)
+#define GLT__TIMER_STOP(timer) ((void)0)
+#endif
+
+/* Just enough of a thread api to start and join threads on windows and posix */
+#ifndef GLT_CHESS_NO_THREADS
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+typedef HANDLE glt__thread;
+#define GLT__THREAD_FUNC(name, arg) static DWORD WINAPI name(LPVOID arg)
+#define GLT__THREAD_RETURN return 0
+
+static inline int glt__thread_start(glt__thread* thread, LPTHREAD_START_ROUTINE func, void* arg)
+{
+        *thread = CreateThread(NULL, 0, func, arg, 0, NULL);
+        return *thread != NULL;
+}
+
+static inline void glt__thread_join(glt__thread thread)
+{
+        WaitForSingleObject(thread, INFINITE);
+        CloseHandle(thread);
+}
+
+static inline int glt__hardware_threads(void)
+{
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return (int)info.dwNumberOfProcessors;
+}
+#else
+#include <pthread.h>
+#include <unistd.h>
+typedef pthread_t glt__thread;
+#define GLT__THREAD_FUNC(name, arg) static void* name(void* arg)
+#define GLT__THREAD_RETURN return NULL
+
+static inline int glt__thread_start(glt__thread* thread, void* (*func)(void*), void* arg)
+{
+        return pthread_create(thread, NULL, func, arg) == 0;
+}
+
+static inline void glt__thread_join(glt__thread thread)
+{
+        pthread_join(thread, NULL);
+}
+
+static inline int glt__hardware_threads(void)
+{
+#ifdef _SC_NPROCESSORS_ONLN
+        long count = sysconf(_SC_NPROCESSORS_ONLN);
+        return count > 0 ? (int)count : 1;
+#else
+        return 1;
+#endif
+}
+#endif
+#endif
+/* Bit operations for accessing and manipulating flags */
+static inline int glt__is_flag_set(u32 flags, glt_flags flag){
+        return (flag & flags) > 0;
+}
+
+static inline void glt__flag_set(u32 *flags, glt_flags flag){
+        *flags |= flag;
+}
+
+static inline void glt__clear_flag(u32 *flags, glt_flags flag){
+        *flags &= ~flag;
+}
+static inline void glt__flip_flag(u32 *flags, glt_flags flag){
+        *flags ^= flag;
+}
+
+static int glt_pos_is_equal(glt_pos a, glt_pos b)
+{
+        return (a.x == b.x) && ( a.y == b.y);
+}
+
+static int glt_piece_is_black(glt_piece piece)
+{
+        return (int)piece > 6;
+}
+
+static int glt_piece_is_white(glt_piece piece)
+{
+        return (int)piece <= 6 &&  (int)piece >=1;
+}
+
+/* The piece of the color, white_piece is one of the GLT_white_* pieces */
+#define GLT__PIECE(color, white_piece) ((glt_piece)((white_piece) + 6 * (color)))
+
+static inline glt_color glt_piece_color(glt_piece piece)
+{
+        return glt_piece_is_black(piece) ? GLT_black : GLT_white;
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+static inline int glt_bb_popcount(u64 bb) { return __builtin_popcountll(bb); }
+static inline int glt_bb_lsb(u64 bb)      { return __builtin_ctzll(bb); }
+#elif defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+static inline int glt_bb_popcount(u64 bb) { return (int)__popcnt64(bb); }
+static inline int glt_bb_lsb(u64 bb)
+{
+        unsigned long index;
+        _BitScanForward64(&index, bb);
+        return (int)index;
+}
+#else
+/* Portable fallbacks for compilers without the intrinsics */
+static inline int glt_bb_popcount(u64 bb)
+{
+        bb = bb - ((bb >> 1) & 0x5555555555555555ull);
+        bb = (bb & 0x3333333333333333ull) + ((bb >> 2) & 0x3333333333333333ull);
+        bb = (bb + (bb >> 4)) & 0x0f0f0f0f0f0f0f0full;
+        return (int)((bb * 0x0101010101010101ull) >> 56);
+}
+static inline int glt_bb_lsb(u64 bb)
+{
+        int index = 0;
+        while (!(bb & 1)) { bb >>= 1; index++; }
+        return index;
+}
+#endif
+
+static inline int glt_bb_pop_lsb(u64* bb)
+{
+        int index = glt_bb_lsb(*bb);
+        *bb &= *bb - 1;
+        return index;
+}
+
+static inline int glt_pos_to_index(glt_pos pos){
+        return (pos.y-1) * 8 + (pos.x -1);
+}
+
+//index starts from 0 and ends at 63
+static inline glt_pos glt_index_to_pos(int index){
+        glt_pos ret;
+        ret.x = (index % 8) + 1;
+        ret.y = (index / 8) + 1;
+        return ret;
+}
+
+/* Get in the piece at the pos */
+static inline int glt_piece_at_pos(glt_chess_board* board, glt_pos pos)
+{
+        return board->pieces[glt_pos_to_index(pos)];
+}
+
+
+static inline glt_color glt_active_color(glt_chess_board* board)
+{
+        return glt__is_flag_set(board->flags, glt_flag_active_color) ? GLT_white : GLT_black;
+}
+
+static inline int glt_piece_is_active_color(glt_chess_board* board, glt_piece piece)
+{
+        if (piece == GLT_none) return 1;
+        else if (glt_piece_is_black(piece) && 
+                !glt__is_flag_set(board->flags, glt_flag_active_color)) return 1;
+        else if (glt_piece_is_white(piece) &&
+                glt__is_flag_set(board->flags, glt_flag_active_color)) return 1;
+
+        return 0;
+
+}
+
+static inline int glt_pieces_is_same_color(glt_piece a, glt_piece b){
+        if (a == GLT_none || b == GLT_none) return 0;
+        else if(glt_piece_is_black(a) && glt_piece_is_black(b)) return 1;
+        else if(glt_piece_is_white(a) && glt_piece_is_white(b)) return 1;
+        return 0;
+}
+
+static inline int glt_pos_in_bounds(glt_pos pos) {
+  return !((pos.x > 8 || pos.x <= 0) || (pos.y > 8 || pos.y <= 0));
+}
+
+static inline u64 glt_pos_to_bb(glt_pos pos)
+{
+        if (!glt_pos_in_bounds(pos)) return 0;
+        return 1ull << glt_pos_to_index(pos);
+}
+
+/* Zobrist keys, filled by glt_init_tables */
+static u64 glt__zobrist_pieces[13][64];
+static u64 glt__zobrist_castling[16];
+static u64 glt__zobrist_en_passant[8];
+static u64 glt__zobrist_side;
+
+/* https://prng.di.unimi.it/splitmix64.c */
+static u64 glt__splitmix64(u64* state)
+{
+        u64 z = (*state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+}
+
+static void glt__init_zobrist(void)
+{
+        /* fixed seed so the keys are the same in every run */
+        u64 seed = 0x676c745f63686573ull;
+
+        /* GLT_none stays 0 so empty squares don't change the key */
+        for (int piece = 1; piece < 13; ++piece)
+                for (int square = 0; square < 64; ++square)
+                        glt__zobrist_pieces[piece][square] = glt__splitmix64(&seed);
+
+        for (int i = 0; i < 16; ++i) glt__zobrist_castling[i] = i ? glt__splitmix64(&seed) : 0;
+        for (int i = 0; i < 8; ++i) glt__zobrist_en_passant[i] = glt__splitmix64(&seed);
+        glt__zobrist_side = glt__splitmix64(&seed);
+}
+
+/*
+ * Material and piece square tables of PeSTO by Ronald Friederich
+ * https://www.chessprogramming.org/PeSTO%27s_Evaluation_Function
+ * In the order of the white pieces, the tables are drawn from white's side so a8 comes first
+ */
+static const i16 glt__pesto_value_mg[6] = {82, 0, 1025, 477, 365, 337};
+static const i16 glt__pesto_value_eg[6] = {94, 0, 936, 512, 297, 281};
+
+static const i16 glt__pesto_mg[6][64] = {
+        /* pawn */
+        {
+                   0,    0,    0,    0,    0,    0,    0,    0,
+                  98,  134,   61,   95,   68,  126,   34,  -11,
+                  -6,    7,   26,   31,   65,   56,   25,  -20,
+                 -14,   13,    6,   21,   23,   12,   17,  -23,
+                 -27,   -2,   -5,   12,   17,    6,   10,  -25,
+                 -26,   -4,   -4,  -10,    3,    3,   33,  -12,
+                 -35,   -1,  -20,  -23,  -15,   24,   38,  -22,
+                   0,    0,    0,    0,    0,    0,    0,    0
+        },
+        /* king */
+        {
+                 -65,   23,   16,  -15,  -56,  -34,    2,   13,
+                  29,   -1,  -20,   -7,   -8,   -4,  -38,  -29,
+                  -9,   24,    2,  -16,  -20,    6,   22,  -22,
+                 -17,  -20,  -12,  -27,  -30,  -25,  -14,  -36,
+                 -49,   -1,  -27,  -39,  -46,  -44,  -33,  -51,
+                 -14,  -14,  -22,  -46,  -44,  -30,  -15,  -27,
+                   1,    7,   -8,  -64,  -43,  -16,    9,    8,
+                 -15,   36,   12,  -54,    8,  -28,   24,   14
+        },
+        /* queen */
+        {
+                 -28,    0,   29,   12,   59,   44,   43,   45,
+                 -24,  -39,   -5,    1,  -16,   57,   28,   54,
+                 -13,  -17,    7,    8,   29,   56,   47,   57,
+                 -27,  -27,  -16,  -16,   -1,   17,   -2,    1,
+                  -9,  -26,   -9,  -10,   -2,   -4,    3,   -3,
+                 -14,    2,  -11,   -2,   -5,    2,   14,    5,
+                 -35,   -8,   11,    2,    8,   15,   -3,    1,
+                  -1,  -18,   -9,   10,  -15,  -25,  -31,  -50
+        },
+        /* rook */
+        {
+                  32,   42,   32,   51,   63,    9,   31,   43,
+                  27,   32,   58,   62,   80,   67,   26,   44,
+                  -5,   19,   26,   36,   17,   45,   61,   16,
+                 -24,  -11,    7,   26,   24,   35,   -8,  -20,
+                 -36,  -26,  -12,   -1,    9,   -7,    6,  -23,
+                 -45,  -25,  -16,  -17,    3,    0,   -5,  -33,
+                 -44,  -16,  -20,   -9,   -1,   11,   -6,  -71,
+                 -19,  -13,    1,   17,   16,    7,  -37,  -26
+        },
+        /* bishop */
+        {
+                 -29,    4,  -82,  -37,  -25,  -42,    7,   -8,
+                 -26,   16,  -18,  -13,   30,   59,   18,  -47,
+                 -16,   37,   43,   40,   35,   50,   37,   -2,
+                  -4,    5,   19,   50,   37,   37,    7,   -2,
+                  -6,   13,   13,   26,   34,   12,   10,    4,
+                   0,   15,   15,   15,   14,   27,   18,   10,
+                   4,   15,   16,    0,    7,   21,   33,    1,
+                 -33,   -3,  -14,  -21,  -13,  -12,  -39,  -21
+        },
+        /* knight */
+        {
+                -167,  -89,  -34,  -49,   61,  -97,  -15, -107,
+                 -73,  -41,   72,   36,   23,   62,    7,  -17,
+                 -47,   60,   37,   65,   84,  129,   73,   44,
+                  -9,   17,   19,   53,   37,   69,   18,   22,
+                 -13,    4,   16,   13,   28,   19,   21,   -8,
+                 -23,   -9,   12,   10,   19,   17,   25,  -16,
+                 -29,  -53,  -12,   -3,   -1,   18,  -14,  -19,
+                -105,  -21,  -58,  -33,  -17,  -28,  -19,  -23
+        }
+};
+
+static const i16 glt__pesto_eg[6][64] = {
+        /* pawn */
+        {
+                   0,    0,    0,    0,    0,    0,    0,    0,
+                 178,  173,  158,  134,  147,  132,  165,  187,
+                  94,  100,   85,   67,   56,   53,   82,   84,
+                  32,   24,   13,    5,   -2,    4,   17,   17,
+                  13,    9,   -3,   -7,   -7,   -8,    3,   -1,
+                   4,    7,   -6,    1,    0,   -5,   -1,   -8,
+                  13,    8,    8,   10,   13,    0,    2,   -7,
+                   0,    0,    0,    0,    0,    0,    0,    0
+        },
+        /* king */
+        {
+                 -74,  -35,  -18,  -18,  -11,   15,    4,  -17,
+                 -12,   17,   14,   17,   17,   38,   23,   11,
+                  10,   17,   23,   15,   20,   45,   44,   13,
+                  -8,   22,   24,   27,   26,   33,   26,    3,
+                 -18,   -4,   21,   24,   27,   23,    9,  -11,
+                 -19,   -3,   11,   21,   23,   16,    7,   -9,
+                 -27,  -11,    4,   13,   14,    4,   -5,  -17,
+                 -53,  -34,  -21,  -11,  -28,  -14,  -24,  -43
+        },
+        /* queen */
+        {
+                  -9,   22,   22,   27,   27,   19,   10,   20,
+                 -17,   20,   32,   41,   58,   25,   30,    0,
+                 -20,    6,    9,   49,   47,   35,   19,    9,
+                   3,   22,   24,   45,   57,   40,   57,   36,
+                 -18,   28,   19,   47,   31,   34,   39,   23,
+                 -16,  -27,   15,    6,    9,   17,   10,    5,
+                 -22,  -23,  -30,  -16,  -16,  -23,  -36,  -32,
+                 -33,  -28,  -22,  -43,   -5,  -32,  -20,  -41
+        },
+        /* rook */
+        {
+                  13,   10,   18,   15,   12,   12,    8,    5,
+                  11,   13,   13,   11,   -3,    3,    8,    3,
+                   7,    7,    7,    5,    4,   -3,   -5,   -3,
+                   4,    3,   13,    1,    2,    1,   -1,    2,
+                   3,    5,    8,    4,   -5,   -6,   -8,  -11,
+                  -4,    0,   -5,   -1,   -7,  -12,   -8,  -16,
+                  -6,   -6,    0,    2,   -9,   -9,  -11,   -3,
+                  -9,    2,    3,   -1,   -5,  -13,    4,  -20
+        },
+        /* bishop */
+        {
+                 -14,  -21,  -11,   -8,   -7,   -9,  -17,  -24,
+                  -8,   -4,    7,  -12,   -3,  -13,   -4,  -14,
+                   2,   -8,    0,   -1,   -2,    6,    0,    4,
+                  -3,    9,   12,    9,   14,   10,    3,    2,
+                  -6,    3,   13,   19,    7,   10,   -3,   -9,
+                 -12,   -3,    8,   10,   13,    3,   -7,  -15,
+                 -14,  -18,   -7,   -1,    4,   -9,  -15,  -27,
+                 -23,   -9,  -23,   -5,   -9,  -16,   -5,  -17
+        },
+        /* knight */
+        {
+                 -58,  -38,  -13,  -28,  -31,  -27,  -63,  -99,
+                 -25,   -8,  -25,   -2,   -9,  -25,  -24,  -52,
+                 -24,  -20,   10,    9,   -1,   -9,  -19,  -41,
+                 -17,    3,   22,   22,   22,   11,    8,  -18,
+                 -18,   -6,   16,   25,   16,   17,    4,  -18,
+                 -23,   -3,   -1,   15,   10,   -3,  -20,  -22,
+                 -42,  -20,  -10,   -5,   -2,  -20,  -23,  -44,
+                 -29,  -51,  -23,  -15,  -22,  -18,  -50,  -64
+        }
+};
+
+/* What a piece adds to the game phase, a full board is 24 */
+static const u8 glt__phase[13] = {0, 0, 0, 4, 2, 1, 1, 0, 0, 4, 2, 1, 1};
+#define GLT__PHASE_MAX 24
+
+/*
+ * Both scores in one int so a move updates them with one add, the low half borrows
+ * from the high one when it's negative so the unpacking rounds it back
+ */
+#define GLT__PSQ(mg, eg) ((i32)((u32)(mg) << 16) + (i32)(eg))
+#define GLT__PSQ_MG(psq) ((i32)(i16)(u16)((u32)((psq) + 0x8000) >> 16))
+#define GLT__PSQ_EG(psq) ((i32)(i16)(u16)(u32)(psq))
+
+/* Value plus square bonus of every piece on every square, black is negative. Filled by glt_init_tables */
+static i32 glt__psq[13][64];
+
+static void glt__init_psq(void)
+{
+        for (int piece = 0; piece < 6; ++piece)
+        {
+                for (int square = 0; square < 64; ++square)
+                {
+                        /* black uses the table of white mirrored up side down */
+                        glt__psq[GLT_white_pawn + piece][square] =
+                                GLT__PSQ(glt__pesto_value_mg[piece] + glt__pesto_mg[piece][square ^ 56],
+                                         glt__pesto_value_eg[piece] + glt__pesto_eg[piece][square ^ 56]);
+                        glt__psq[GLT_black_pawn + piece][square] =
+                                GLT__PSQ(-(glt__pesto_value_mg[piece] + glt__pesto_mg[piece][square]),
+                                         -(glt__pesto_value_eg[piece] + glt__pesto_eg[piece][square]));
+                }
+        }
+}
+
+/* Sums the evaluation terms from scratch, the incremental sums should always be the same */
+static void glt__board_compute_psq(glt_chess_board* board, i32* psq, int* phase)
+{
+        *psq = 0;
+        *phase = 0;
+
+        for (int i = 0; i < 64; ++i)
+        {
+                *psq += glt__psq[board->pieces[i]][i];
+                *phase += glt__phase[board->pieces[i]];
+        }
+}
+
+/* The castling flags as a 4 bit index */
+static inline int glt__castling_index(u32 flags)
+{
+        return (flags >> 2) & 15;
+}
+
+static inline u64 glt_board_hash(glt_chess_board* board)
+{
+        return board->hash;
+}
+
+static u64 glt_board_compute_hash(glt_chess_board* board)
+{
+        u64 hash = 0;
+
+        for (int i = 0; i < 64; ++i) hash ^= glt__zobrist_pieces[board->pieces[i]][i];
+
+        hash ^= glt__zobrist_castling[glt__castling_index(board->flags)];
+        if (board->en_passant >= 0) hash ^= glt__zobrist_en_passant[board->en_passant & 7];
+        if (!glt__is_flag_set(board->flags, glt_flag_active_color)) hash ^= glt__zobrist_side;
+
+        return hash;
+}
+
+/* These keep the bitboards, the hash and the evaluation in sync, everything that moves a piece should go thru them */
+static inline void glt__board_put_piece(glt_chess_board* board, int index, glt_piece piece)
+{
+        u64 bb = 1ull << index;
+
+        board->pieces[index] = piece;
+        board->hash ^= glt__zobrist_pieces[piece][index];
+        board->psq += glt__psq[piece][index];
+        board->phase += glt__phase[piece];
+        board->bb_pieces[GLT_none] &= ~bb;
+        board->bb_pieces[piece] |= bb;
+        board->bb_color[glt_piece_color(piece)] |= bb;
+        board->bb_occupied |= bb;
+}
+
+static inline void glt__board_remove_piece(glt_chess_board* board, int index)
+{
+        u64 bb = 1ull << index;
+        glt_piece piece = board->pieces[index];
+
+        if (piece == GLT_none) return;
+
+        board->pieces[index] = GLT_none;
+        board->hash ^= glt__zobrist_pieces[piece][index];
+        board->psq -= glt__psq[piece][index];
+        board->phase -= glt__phase[piece];
+        board->bb_pieces[piece] &= ~bb;
+        board->bb_color[glt_piece_color(piece)] &= ~bb;
+        board->bb_occupied &= ~bb;
+        board->bb_pieces[GLT_none] |= bb;
+}
+
+/*
+ * Leaper attack tables, index is the square (0 to 63)
+ * Generated offline, every entry is the set of squares the piece attacks from that square
+ */
+static const u64 glt__knight_table[64] = {
+        0x0000000000020400ull, 0x0000000000050800ull, 0x00000000000a1100ull, 0x0000000000142200ull,
+        0x0000000000284400ull, 0x0000000000508800ull, 0x0000000000a01000ull, 0x0000000000402000ull,
+        0x0000000002040004ull, 0x0000000005080008ull, 0x000000000a110011ull, 0x0000000014220022ull,
+        0x0000000028440044ull, 0x0000000050880088ull, 0x00000000a0100010ull, 0x0000000040200020ull,
+        0x0000000204000402ull, 0x0000000508000805ull, 0x0000000a1100110aull, 0x0000001422002214ull,
+        0x0000002844004428ull, 0x0000005088008850ull, 0x000000a0100010a0ull, 0x0000004020002040ull,
+        0x0000020400040200ull, 0x0000050800080500ull, 0x00000a1100110a00ull, 0x0000142200221400ull,
+        0x0000284400442800ull, 0x0000508800885000ull, 0x0000a0100010a000ull, 0x0000402000204000ull,
+        0x0002040004020000ull, 0x0005080008050000ull, 0x000a1100110a0000ull, 0x0014220022140000ull,
+        0x0028440044280000ull, 0x0050880088500000ull, 0x00a0100010a00000ull, 0x0040200020400000ull,
+        0x0204000402000000ull, 0x0508000805000000ull, 0x0a1100110a000000ull, 0x1422002214000000ull,
+        0x2844004428000000ull, 0x5088008850000000ull, 0xa0100010a0000000ull, 0x4020002040000000ull,
+        0x0400040200000000ull, 0x0800080500000000ull, 0x1100110a00000000ull, 0x2200221400000000ull,
+        0x4400442800000000ull, 0x8800885000000000ull, 0x100010a000000000ull, 0x2000204000000000ull,
+        0x0004020000000000ull, 0x0008050000000000ull, 0x00110a0000000000ull, 0x0022140000000000ull,
+        0x0044280000000000ull, 0x0088500000000000ull, 0x0010a00000000000ull, 0x0020400000000000ull
+};
+
+static const u64 glt__king_table[64] = {
+        0x0000000000000302ull, 0x0000000000000705ull, 0x0000000000000e0aull, 0x0000000000001c14ull,
+        0x0000000000003828ull, 0x0000000000007050ull, 0x000000000000e0a0ull, 0x000000000000c040ull,
+        0x0000000000030203ull, 0x0000000000070507ull, 0x00000000000e0a0eull, 0x00000000001c141cull,
+        0x0000000000382838ull, 0x0000000000705070ull, 0x0000000000e0a0e0ull, 0x0000000000c040c0ull,
+        0x0000000003020300ull, 0x0000000007050700ull, 0x000000000e0a0e00ull, 0x000000001c141c00ull,
+        0x0000000038283800ull, 0x0000000070507000ull, 0x00000000e0a0e000ull, 0x00000000c040c000ull,
+        0x0000000302030000ull, 0x0000000705070000ull, 0x0000000e0a0e0000ull, 0x0000001c141c0000ull,
+        0x0000003828380000ull, 0x0000007050700000ull, 0x000000e0a0e00000ull, 0x000000c040c00000ull,
+        0x0000030203000000ull, 0x0000070507000000ull, 0x00000e0a0e000000ull, 0x00001c141c000000ull,
+        0x0000382838000000ull, 0x0000705070000000ull, 0x0000e0a0e0000000ull, 0x0000c040c0000000ull,
+        0x0003020300000000ull, 0x0007050700000000ull, 0x000e0a0e00000000ull, 0x001c141c00000000ull,
+        0x0038283800000000ull, 0x0070507000000000ull, 0x00e0a0e000000000ull, 0x00c040c000000000ull,
+        0x0302030000000000ull, 0x0705070000000000ull, 0x0e0a0e0000000000ull, 0x1c141c0000000000ull,
+        0x3828380000000000ull, 0x7050700000000000ull, 0xe0a0e00000000000ull, 0xc040c00000000000ull,
+        0x0203000000000000ull, 0x0507000000000000ull, 0x0a0e000000000000ull, 0x141c000000000000ull,
+        0x2838000000000000ull, 0x5070000000000000ull, 0xa0e0000000000000ull, 0x40c0000000000000ull
+};
+
+/* Pawns only attack diagonally forward so there is a table per color */
+static const u64 glt__pawn_table[2][64] = {
+        {
+                0x0000000000000200ull, 0x0000000000000500ull, 0x0000000000000a00ull, 0x0000000000001400ull,
+                0x0000000000002800ull, 0x0000000000005000ull, 0x000000000000a000ull, 0x0000000000004000ull,
+                0x0000000000020000ull, 0x0000000000050000ull, 0x00000000000a0000ull, 0x0000000000140000ull,
+                0x0000000000280000ull, 0x0000000000500000ull, 0x0000000000a00000ull, 0x0000000000400000ull,
+                0x0000000002000000ull, 0x0000000005000000ull, 0x000000000a000000ull, 0x0000000014000000ull,
+                0x0000000028000000ull, 0x0000000050000000ull, 0x00000000a0000000ull, 0x0000000040000000ull,
+                0x0000000200000000ull, 0x0000000500000000ull, 0x0000000a00000000ull, 0x0000001400000000ull,
+                0x0000002800000000ull, 0x0000005000000000ull, 0x000000a000000000ull, 0x0000004000000000ull,
+                0x0000020000000000ull, 0x0000050000000000ull, 0x00000a0000000000ull, 0x0000140000000000ull,
+                0x0000280000000000ull, 0x0000500000000000ull, 0x0000a00000000000ull, 0x0000400000000000ull,
+                0x0002000000000000ull, 0x0005000000000000ull, 0x000a000000000000ull, 0x0014000000000000ull,
+                0x0028000000000000ull, 0x0050000000000000ull, 0x00a0000000000000ull, 0x0040000000000000ull,
+                0x0200000000000000ull, 0x0500000000000000ull, 0x0a00000000000000ull, 0x1400000000000000ull,
+                0x2800000000000000ull, 0x5000000000000000ull, 0xa000000000000000ull, 0x4000000000000000ull,
+                0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+                0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull
+        },
+        {
+                0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+                0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+                0x0000000000000002ull, 0x0000000000000005ull, 0x000000000000000aull, 0x0000000000000014ull,
+                0x0000000000000028ull, 0x0000000000000050ull, 0x00000000000000a0ull, 0x0000000000000040ull,
+                0x0000000000000200ull, 0x0000000000000500ull, 0x0000000000000a00ull, 0x0000000000001400ull,
+                0x0000000000002800ull, 0x0000000000005000ull, 0x000000000000a000ull, 0x0000000000004000ull,
+                0x0000000000020000ull, 0x0000000000050000ull, 0x00000000000a0000ull, 0x0000000000140000ull,
+                0x0000000000280000ull, 0x0000000000500000ull, 0x0000000000a00000ull, 0x0000000000400000ull,
+                0x0000000002000000ull, 0x0000000005000000ull, 0x000000000a000000ull, 0x0000000014000000ull,
+                0x0000000028000000ull, 0x0000000050000000ull, 0x00000000a0000000ull, 0x0000000040000000ull,
+                0x0000000200000000ull, 0x0000000500000000ull, 0x0000000a00000000ull, 0x0000001400000000ull,
+                0x0000002800000000ull, 0x0000005000000000ull, 0x000000a000000000ull, 0x0000004000000000ull,
+                0x0000020000000000ull, 0x0000050000000000ull, 0x00000a0000000000ull, 0x0000140000000000ull,
+                0x0000280000000000ull, 0x0000500000000000ull, 0x0000a00000000000ull, 0x0000400000000000ull,
+                0x0002000000000000ull, 0x0005000000000000ull, 0x000a000000000000ull, 0x0014000000000000ull,
+                0x0028000000000000ull, 0x0050000000000000ull, 0x00a0000000000000ull, 0x0040000000000000ull
+        },
+};
+
+static inline u64 glt_knight_attacks(int square)
+{
+        return glt__knight_table[square];
+}
+
+static inline u64 glt_king_attacks(int square)
+{
+        return glt__king_table[square];
+}
+
+static inline u64 glt_pawn_attacks(glt_color color, int square)
+{
+        return glt__pawn_table[color][square];
+}
+
+/*
+ * Magic bitboards
+ * https://www.chessprogramming.org/Magic_Bitboards
+ *
+ * For every square the occupancy of the squares on the rays (without the board edges, they
+ * never block anything) is hashed to a index in that square's slice of the attack table.
+ * The magic numbers are found offline so that no two occupancies with different attacks collide.
+ */
+typedef struct {
+        u64 mask;     /* relevant occupancy */
+        u64 magic;
+        u64* attacks; /* slice of the attack table for the square */
+        int shift;
+} glt__magic;
+
+static const u64 glt__rook_magic_numbers[64] = {
+        0x1080004008801020ull, 0x0840092002c03000ull, 0x1900200010400900ull, 0x0880100008000480ull,
+        0x4200100420080200ull, 0x8100020100080400ull, 0x0200040110886200ull, 0x0200008040220411ull,
+        0x0404800084400220ull, 0x0000401000402000ull, 0x0086001081220440ull, 0x0408800800100280ull,
+        0x000a001201040820ull, 0x8848800200840080ull, 0x4001000100040200ull, 0x0442000102105084ull,
+        0x9080010020804100ull, 0x0040404000201009ull, 0x0000808010002009ull, 0x2200090021d00100ull,
+        0x0008008008040080ull, 0x0004004002010040ull, 0x0011040008015042ull, 0x00000a0001768104ull,
+        0x0000800080204009ull, 0x2010004140002001ull, 0x9800200280100080ull, 0x1000100080080080ull,
+        0x0442000a00049020ull, 0x2100040080020080ull, 0x0800120400900148ull, 0x0010040a00128541ull,
+        0x2800804000800030ull, 0x1010002000400041ull, 0x4000200011004100ull, 0x0610008410800800ull,
+        0x0400802402800800ull, 0xc100020080800400ull, 0x0002000802000401ull, 0x0182085882000401ull,
+        0x0220204000808000ull, 0x2860100040024022ull, 0x0001002004110040ull, 0x99101042000a0020ull,
+        0x0004080004008080ull, 0x0010040002008080ull, 0x2012004881020004ull, 0x8300842444820011ull,
+        0x0088403882010200ull, 0x0820400080210100ull, 0x0110910040a00300ull, 0x0801100280080480ull,
+        0x0242009008200600ull, 0x1002000489500200ull, 0x0040800200010080ull, 0x0091800041000080ull,
+        0x0000209300488001ull, 0x04c1002414824001ull, 0x020020000b001041ull, 0x7000100004200901ull,
+        0x8002002004100802ull, 0x30010002084c0007ull, 0x0888221800813004ull, 0x4000002840840112ull
+};
+
+static const u64 glt__bishop_magic_numbers[64] = {
+        0xa010041108003100ull, 0x006082020a002900ull, 0x6810010619200000ull, 0x08281a0520000408ull,
+        0x0001104001000400ull, 0x0018901008048400ull, 0x00040a0210245280ull, 0x000200210808a402ull,
+        0x9140048410821200ull, 0x0800091010820041ull, 0x20504804832202c0ull, 0x0100091401081000ull,
+        0x8021011140000012ull, 0x0810020804450400ull, 0x208b0542109008a2ull, 0x0080084a08040204ull,
+        0x0040e2a80811244cull, 0x2505022008008108ull, 0x0430220100420040ull, 0x010a040420220040ull,
+        0x1105000290400000ull, 0x0093001200822120ull, 0x4000a62048043004ull, 0x280120048a015004ull,
+        0x006090002a020814ull, 0x44042000240800d0ull, 0x01102800040a4400ull, 0x1004080080220040ull,
+        0x0001001011004024ull, 0x0010044000805040ull, 0x0914041200820100ull, 0x0004821012821480ull,
+        0x0024040500c05021ull, 0x0088611002080200ull, 0x0116080a00040020ull, 0x4000020080080080ull,
+        0x2450450140840040ull, 0x0000880201484100ull, 0x0222020404020092ull, 0x8081110600002e00ull,
+        0x2842101105000801ull, 0x1100809008001025ull, 0x00020202221c0400ull, 0x0422014022009020ull,
+        0x0210046102100c00ull, 0xc004008082029102ull, 0x00aa461801101200ull, 0x0404080080201108ull,
+        0x020542108c205002ull, 0x0410544804100100ull, 0x0040910841100000ull, 0x0400200042021100ull,
+        0x00004204850400c0ull, 0x0200100410a42102ull, 0x1040020801210102ull, 0x0805040410420000ull,
+        0x2884804130100200ull, 0x800c262201242000ull, 0x1058000194108800ull, 0x0014221054420204ull,
+        0x0104000012a02200ull, 0x0200881003300100ull, 0x0140400202840100ull, 0x0402020801010201ull
+};
+
+static glt__magic glt__rook_magics[64];
+static glt__magic glt__bishop_magics[64];
+static u64 glt__rook_table[102400];
+static u64 glt__bishop_table[5248];
+static int glt__tables_ready = 0;
+
+static u64 glt__between[64][64]; /* the squares between two squares on a line, empty if they aren't on one */
+static u64 glt__line[64][64];    /* all of the line thru two squares, empty if they aren't on one */
+
+#if defined(GLT_CHESS_USE_PEXT) && (defined(__BMI2__) || (defined(_MSC_VER) && defined(__AVX2__)))
+#include <immintrin.h>
+#define GLT__PEXT_ALWAYS 1
+#elif defined(GLT_CHESS_USE_PEXT) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define GLT__PEXT_RUNTIME 1
+static int glt__use_pext = 0;
+__attribute__((target("bmi2"))) static u64 glt__pext(u64 bb, u64 mask) { return _pext_u64(bb, mask); }
+#endif
+
+static inline u64 glt__magic_index(const glt__magic* m, u64 occupied)
+{
+#if defined(GLT__PEXT_ALWAYS)
+        return _pext_u64(occupied, m->mask);
+#else
+#if defined(GLT__PEXT_RUNTIME)
+        if (glt__use_pext) return glt__pext(occupied, m->mask);
+#endif
+        return ((occupied & m->mask) * m->magic) >> m->shift;
+#endif
+}
+
+static inline u64 glt_rook_attacks(int square, u64 occupied)
+{
+        const glt__magic* m = &glt__rook_magics[square];
+        return m->attacks[glt__magic_index(m, occupied)];
+}
+
+static inline u64 glt_bishop_attacks(int square, u64 occupied)
+{
+        const glt__magic* m = &glt__bishop_magics[square];
+        return m->attacks[glt__magic_index(m, occupied)];
+}
+
+static inline u64 glt_queen_attacks(int square, u64 occupied)
+{
+        return glt_rook_attacks(square, occupied) | glt_bishop_attacks(square, occupied);
+}
+
+/* Every piece of either color that attacks the square, sliders are blocked by occupied */
+static inline u64 glt__attackers_to(glt_chess_board* board, int square, u64 occupied)
+{
+        const u64* bb = board->bb_pieces;
+        u64 diagonal = bb[GLT_white_bishop] | bb[GLT_black_bishop] | bb[GLT_white_queen] | bb[GLT_black_queen];
+        u64 straight = bb[GLT_white_rook] | bb[GLT_black_rook] | bb[GLT_white_queen] | bb[GLT_black_queen];
+
+        return (glt_pawn_attacks(GLT_black, square) & bb[GLT_white_pawn])
+             | (glt_pawn_attacks(GLT_white, square) & bb[GLT_black_pawn])
+             | (glt_knight_attacks(square) & (bb[GLT_white_knight] | bb[GLT_black_knight]))
+             | (glt_king_attacks(square) & (bb[GLT_white_king] | bb[GLT_black_king]))
+             | (glt_bishop_attacks(square, occupied) & diagonal)
+             | (glt_rook_attacks(square, occupied) & straight);
+}
+
+static inline int glt__square_attacked(glt_chess_board* board, int square, glt_color by)
+{
+        return (glt__attackers_to(board, square, board->bb_occupied) & board->bb_color[by]) != 0;
+}
+
+static inline u64 glt_attackers_to(glt_chess_board* board, int square, glt_color color)
+{
+        return glt__attackers_to(board, square, board->bb_occupied) & board->bb_color[color];
+}
+
+static inline int glt_is_square_attacked(glt_chess_board* board, int square, glt_color color)
+{
+        return glt__square_attacked(board, square, color);
+}
+
+/* The pieces giving check to the side to move, computed for board->checkers */
+static inline u64 glt__compute_checkers(glt_chess_board* board)
+{
+        glt_color us = glt_active_color(board);
+        u64 king = board->bb_pieces[GLT__PIECE(us, GLT_white_king)];
+
+        if (!king) return 0;
+        return glt_attackers_to(board, glt_bb_lsb(king), (glt_color)(us ^ 1));
+}
+
+static inline u64 glt_board_checkers(glt_chess_board* board)
+{
+        return board->checkers;
+}
+
+static inline int glt_in_check(glt_chess_board* board)
+{
+        return board->checkers != 0;
+}
+
+/* The pieces of the kind (and color) of piece that attack the square, pawns only by capturing */
+static inline u64 glt__piece_attackers(glt_chess_board* board, glt_piece piece, int square)
+{
+        u64 bb = board->bb_pieces[piece];
+
+        switch (piece) {
+                case GLT_white_pawn:   return glt_pawn_attacks(GLT_black, square) & bb;
+                case GLT_black_pawn:   return glt_pawn_attacks(GLT_white, square) & bb;
+                case GLT_white_knight:
+                case GLT_black_knight: return glt_knight_attacks(square) & bb;
+                case GLT_white_bishop:
+                case GLT_black_bishop: return glt_bishop_attacks(square, board->bb_occupied) & bb;
+                case GLT_white_rook:
+                case GLT_black_rook:   return glt_rook_attacks(square, board->bb_occupied) & bb;
+                case GLT_white_queen:
+                case GLT_black_queen:  return glt_queen_attacks(square, board->bb_occupied) & bb;
+                case GLT_white_king:
+                case GLT_black_king:   return glt_king_attacks(square) & bb;
+                default:               return 0;
+        }
+}
+
+/* 
+ * Walks the rays one square at a time, only used to fill the tables
+ * When edges is set it returns the relevant occupancy mask instead of the attacks
+ */
+static u64 glt__slider_attacks_slow(int square, u64 occupied, const glt_pos* dirs, int edges)
+{
+        u64 attacks = 0;
+
+        for (int i = 0; i < 4; i++)
+        {
+                glt_pos pos = glt_index_to_pos(square);
+                pos.x += dirs[i].x;
+                pos.y += dirs[i].y;
+
+                while (glt_pos_in_bounds(pos))
+                {
+                        glt_pos next = {(i8)(pos.x + dirs[i].x), (i8)(pos.y + dirs[i].y)};
+                        u64 bb = glt_pos_to_bb(pos);
+
+                        if (edges && !glt_pos_in_bounds(next)) break;
+
+                        attacks |= bb;
+                        if (!edges && (occupied & bb)) break;
+
+                        pos = next;
+                }
+        }
+        return attacks;
+}
+
+static u64* glt__init_magics(glt__magic* magics, const u64* numbers, u64* table, const glt_pos* dirs)
+{
+        for (int square = 0; square < 64; ++square)
+        {
+                glt__magic* m = &magics[square];
+
+                m->mask = glt__slider_attacks_slow(square, 0, dirs, 1);
+                m->magic = numbers[square];
+                m->shift = 64 - glt_bb_popcount(m->mask);
+                m->attacks = table;
+
+                /* walk all the subsets of the mask (carry rippler) */
+                u64 occupied = 0;
+                do {
+                        m->attacks[glt__magic_index(m, occupied)] = glt__slider_attacks_slow(square, occupied, dirs, 0);
+                        occupied = (occupied - m->mask) & m->mask;
+                } while (occupied);
+
+                table += 1ull << glt_bb_popcount(m->mask);
+        }
+        return table;
+}
+
+static void glt__init_lines(void)
+{
+        for (int a = 0; a < 64; ++a)
+        {
+                for (int b = 0; b < 64; ++b)
+                {
+                        u64 bb_a = 1ull << a, bb_b = 1ull << b;
+
+                        glt__between[a][b] = 0;
+                        glt__line[a][b] = 0;
+                        if (a == b) continue;
+
+                        if (glt_rook_attacks(a, 0) & bb_b) {
+                                glt__between[a][b] = glt_rook_attacks(a, bb_b) & glt_rook_attacks(b, bb_a);
+                                glt__line[a][b] = (glt_rook_attacks(a, 0) & glt_rook_attacks(b, 0)) | bb_a | bb_b;
+                        } else if (glt_bishop_attacks(a, 0) & bb_b) {
+                                glt__between[a][b] = glt_bishop_attacks(a, bb_b) & glt_bishop_attacks(b, bb_a);
+                                glt__line[a][b] = (glt_bishop_attacks(a, 0) & glt_bishop_attacks(b, 0)) | bb_a | bb_b;
+                        }
+                }
+        }
+}
+
+static void glt_init_tables(void)
+{
+        static const glt_pos rook_dirs[4]   = {{ 0, 1}, {0, -1}, { 1, 0}, {-1, 0}};
+        static const glt_pos bishop_dirs[4] = {{ 1, 1}, {1, -1}, { -1, 1}, {-1, -1}};
+
+        if (glt__tables_ready) return;
+
+#if defined(GLT__PEXT_RUNTIME)
+        __builtin_cpu_init();
+        glt__use_pext = __builtin_cpu_supports("bmi2");
+#endif
+
+        u64* rook_end = glt__init_magics(glt__rook_magics, glt__rook_magic_numbers, glt__rook_table, rook_dirs);
+        u64* bishop_end = glt__init_magics(glt__bishop_magics, glt__bishop_magic_numbers, glt__bishop_table, bishop_dirs);
+
+        assert(rook_end == glt__rook_table + 102400);
+        assert(bishop_end == glt__bishop_table + 5248);
+        (void)rook_end;
+        (void)bishop_end;
+
+        glt__init_lines();
+        glt__init_zobrist();
+        glt__init_psq();
+
+        glt__tables_ready = 1;
+}
+
+static void glt_board_sync_bitboards(glt_chess_board* board)
+{
+        glt_init_tables();
+
+        for (int i = 0; i < 13; ++i) board->bb_pieces[i] = 0;
+        board->bb_color[GLT_white] = 0;
+        board->bb_color[GLT_black] = 0;
+        board->bb_occupied = 0;
+
+        for (int i = 0; i < 64; ++i) {
+                glt_piece piece = board->pieces[i];
+                u64 bb = 1ull << i;
+
+                board->bb_pieces[piece] |= bb;
+                if (piece == GLT_none) continue;
+
+                board->bb_color[glt_piece_color(piece)] |= bb;
+                board->bb_occupied |= bb;
+        }
+
+        board->hash = glt_board_compute_hash(board);
+        board->checkers = glt__compute_checkers(board);
+
+        int phase;
+        glt__board_compute_psq(board, &board->psq, &phase);
+        board->phase = (u8)phase;
+}
+
+static void glt_board_set_piece(glt_chess_board* board, glt_pos pos, glt_piece piece)
+{
+        assert(glt_pos_in_bounds(pos));
+
+        int index = glt_pos_to_index(pos);
+        glt__board_remove_piece(board, index);
+        if (piece != GLT_none) glt__board_put_piece(board, index, piece);
+}
+
+static inline glt_pos glt_coord_to_pos(glt_coord coord){
+        glt_pos ret = { (int)coord.file - 64,  coord.rank};
+        return ret;
+}
+
+static inline glt_coord glt_pos_to_coord(glt_pos pos){
+        glt_coord ret = { 64 + (int)pos.x ,  pos.y};
+        return ret;
+}
+
+
+
+static void glt_initilize_board(glt_chess_board* board){
+        board->pieces[0] = GLT_white_rook;
+        board->pieces[1] = GLT_white_knight;
+        board->pieces[2] = GLT_white_bishop;
+        board->pieces[3] = GLT_white_queen;
+        board->pieces[4] = GLT_white_king;
+        board->pieces[5] = GLT_white_bishop;
+        board->pieces[6] = GLT_white_knight;
+        board->pieces[7] = GLT_white_rook;
 
         for (int i = 0; i < 8; ++i) {
                 board->pieces[8 + i] = GLT_white_pawn;
         }
 
-        for (int i = 8; i < 48; ++i) {
-                board->pieces[8 + i] = GLT_none;
+        for (int i = 8; i < 48; ++i) {
+                board->pieces[8 + i] = GLT_none;
+        }
+
+        board->pieces[56 + 0] = GLT_black_rook;
+        board->pieces[56 + 1] = GLT_black_knight;
+        board->pieces[56 + 2] = GLT_black_bishop;
+        board->pieces[56 + 3] = GLT_black_queen;
+        board->pieces[56 + 4] = GLT_black_king;
+        board->pieces[56 + 5] = GLT_black_bishop;
+        board->pieces[56 + 6] = GLT_black_knight;
+        board->pieces[56 + 7] = GLT_black_rook;
+
+        for (int i = 0; i < 8; ++i) {
+                board->pieces[48 + i] = GLT_black_pawn;
+        }
+
+        board->flags = 0;
+        glt__flag_set(&board->flags, glt_flag_active_color);
+        glt__flag_set(&board->flags, glt_white_king_castle);
+        glt__flag_set(&board->flags, glt_white_queen_castle);
+        glt__flag_set(&board->flags, glt_black_king_castle);
+        glt__flag_set(&board->flags, glt_black_queen_castle);
+        board->en_passant = -1;
+        board->history = NULL;
+        board->half_move_clock = 0;
+        board->full_move_clock = 1;
+
+        glt_board_sync_bitboards(board);
+        //board->fen = (char*)malloc(1000);
+}
+
+/* Arena allocations are aligned to this */
+#define GLT__ARENA_ALIGN 16
+
+/* The arena the nodes of this thread are allocated from */
+static GLT_THREAD_LOCAL glt_arena* glt__thread_arena = NULL;
+
+static void glt_arena_init(glt_arena* arena, void* memory, size_t capacity)
+{
+        arena->base = (u8*)memory;
+        arena->capacity = memory ? capacity : 0;
+        arena->used = 0;
+        arena->owns_memory = 0;
+}
+
+static int glt_arena_create(glt_arena* arena, size_t capacity)
+{
+        void* memory = GLT_malloc(capacity);
+        glt_arena_init(arena, memory, capacity);
+        arena->owns_memory = 1;
+        return memory != NULL;
+}
+
+static void glt_arena_destroy(glt_arena* arena)
+{
+        if (glt__thread_arena == arena) glt__thread_arena = NULL;
+        if (arena->owns_memory && arena->base) GLT_free(arena->base);
+        glt_arena_init(arena, NULL, 0);
+}
+
+static void* glt_arena_alloc(glt_arena* arena, size_t size)
+{
+        size_t start = (arena->used + (GLT__ARENA_ALIGN - 1)) & ~(size_t)(GLT__ARENA_ALIGN - 1);
+
+        if (start + size > arena->capacity) return NULL;
+
+        arena->used = start + size;
+        return arena->base + start;
+}
+
+static inline void glt_arena_reset(glt_arena* arena)
+{
+        arena->used = 0;
+}
+
+static glt_arena* glt_arena_bind(glt_arena* arena)
+{
+        glt_arena* prev = glt__thread_arena;
+        glt__thread_arena = arena;
+        return prev;
+}
+
+/*
+ * Every node starts with a header that says where it came from, so freeing it doesn't depend
+ * on which arena is bound at the time. The header keeps the node aligned like the arena does
+ */
+#define GLT__NODE_HEADER GLT__ARENA_ALIGN
+#define GLT__NODE_HEAP   0x676c7468u /* "glth" */
+#define GLT__NODE_ARENA  0x676c7461u /* "glta" */
+
+static inline void* glt__node_mark(u8* memory, u32 origin)
+{
+        memcpy(memory, &origin, sizeof(origin));
+        return memory + GLT__NODE_HEADER;
+}
+
+/* All the linked list nodes are allocated and freed thru these two */
+static void* glt__node_alloc(size_t size)
+{
+        glt_arena* arena = glt__thread_arena;
+        u8* memory;
+
+        GLT__COUNT(GLT_counter_node_allocs, 1);
+
+        if (arena) {
+                memory = (u8*)glt_arena_alloc(arena, size + GLT__NODE_HEADER);
+                if (memory) return glt__node_mark(memory, GLT__NODE_ARENA);
+        }
+
+        GLT__COUNT(GLT_counter_node_mallocs, 1);
+        memory = (u8*)GLT_malloc(size + GLT__NODE_HEADER);
+        return memory ? glt__node_mark(memory, GLT__NODE_HEAP) : NULL;
+}
+
+static void glt__node_free(void* node)
+{
+        u8* memory = (u8*)node - GLT__NODE_HEADER;
+        u32 origin;
+
+        memcpy(&origin, memory, sizeof(origin));
+
+        /* anything else is a node of an arena that was reset or destroyed, or a node freed twice */
+        assert(origin == GLT__NODE_HEAP || origin == GLT__NODE_ARENA);
+
+        /* arena nodes are freed when the arena is reset */
+        if (origin != GLT__NODE_HEAP) return;
+
+        origin = 0;
+        memcpy(memory, &origin, sizeof(origin));
+        GLT_free(memory);
+}
+
+static void glt_moves_delte(glt_move** head_ptr){
+        
+        glt_move* prev = *head_ptr;
+        glt_move* curr = prev;
+
+        while(curr){
+                prev = curr->next;
+                glt__node_free(curr);
+                curr = prev;
+        }
+
+        *head_ptr = NULL;
+}
+
+static void glt_move_audits_delte(glt_move_audit** head_ptr){
+
+        glt_move_audit* prev = *head_ptr;
+        glt_move_audit* curr = prev;
+
+        while(curr){
+                prev = curr->next;
+                glt__node_free(curr);
+                curr = prev;
+        }
+
+        *head_ptr = NULL;
+}
+
+/* Same as glt__move_append but for the move audit list */
+static glt_move_audit** glt__move_audit_append(glt_move_audit** tail_ptr, glt_move_audit audit){
+        assert(tail_ptr != NULL);
+
+        glt_move_audit* new_audit = (glt_move_audit*)glt__node_alloc(sizeof(glt_move_audit));
+
+        if (new_audit == NULL)
+        {
+                //Failed to malloc
+                assert(0);
+                return tail_ptr;
+        }
+
+        *new_audit = audit;
+        new_audit->next = NULL;
+        *tail_ptr = new_audit;
+
+        return &new_audit->next;
+}
+
+/**
+ * This is just a simple append function for the linked list
+ * this is heavely used inside the chess engies for generating moves and might not
+ * be required outside the library
+ *
+ * It takes the address of the last next pointer (&head for a empty list) and returns
+ * the address of the next pointer of the new node, so appending doesn't walk the list
+ */
+static glt_move** glt__move_append(glt_move** tail_ptr, glt_move move){
+        /* you can't insert if the tail pointer is null */
+        assert(tail_ptr != NULL);
+
+        /* Cast to glt_move because c++ gives you error if you don't*/
+        glt_move* new_move = (glt_move*)glt__node_alloc(sizeof(glt_move));
+
+        if (new_move == NULL)
+        {
+                //Failed to malloc
+                assert(0);
+                return tail_ptr;
+        }
+
+        *new_move = move;
+        new_move->next = NULL;
+        *tail_ptr = new_move;
+
+        return &new_move->next;
+}
+
+static inline void glt_move_list_clear(glt_move_list* list)
+{
+        list->count = 0;
+}
+
+/* The ranks a pawn lands on after the first step of a double push */
+#define GLT__RANK_3 0x0000000000ff0000ull
+#define GLT__RANK_6 0x0000ff0000000000ull
+
+/* The ranks a pawn promotes on */
+#define GLT__RANK_1 0x00000000000000ffull
+#define GLT__RANK_8 0xff00000000000000ull
+
+/* What the internal generators should emit */
+#define GLT__GEN_CAPTURES   1
+#define GLT__GEN_QUIETS     2
+#define GLT__GEN_PROMOTIONS 4 /* only the promotions that don't capture, the quiets have them too */
+#define GLT__GEN_ALL        (GLT__GEN_CAPTURES | GLT__GEN_QUIETS)
+
+static inline glt_move16 glt_move16_encode(int from, int to, int flags)
+{
+        return (glt_move16)(from | (to << 6) | (flags << 12));
+}
+
+static inline int glt_move16_from(glt_move16 move) { return move & 63; }
+static inline int glt_move16_to(glt_move16 move) { return (move >> 6) & 63; }
+static inline int glt_move16_flags(glt_move16 move) { return move >> 12; }
+
+static inline int glt_move16_is_capture(glt_move16 move)
+{
+        return (glt_move16_flags(move) & GLT_move_capture) != 0;
+}
+
+static inline int glt_move16_is_promotion(glt_move16 move)
+{
+        return (glt_move16_flags(move) & GLT_move_knight_promotion) != 0;
+}
+
+static inline int glt_move16_is_castle(glt_move16 move)
+{
+        return glt_move16_flags(move) == GLT_move_king_castle || glt_move16_flags(move) == GLT_move_queen_castle;
+}
+
+static inline glt_piece glt_move16_promotion(glt_move16 move, glt_color color)
+{
+        static const glt_piece promotions[4] = {GLT_white_knight, GLT_white_bishop, GLT_white_rook, GLT_white_queen};
+
+        if (!glt_move16_is_promotion(move)) return GLT_none;
+        return GLT__PIECE(color, promotions[glt_move16_flags(move) & 3]);
+}
+
+static glt_move glt_move16_to_move(glt_move16 move)
+{
+        glt_move ret = {{0, 0}, {0, 0}, NULL, GLT_none};
+        int to = glt_move16_to(move);
+
+        ret.start = glt_index_to_pos(glt_move16_from(move));
+        ret.end = glt_index_to_pos(to);
+        ret.promotion = glt_move16_promotion(move, to >= 56 ? GLT_white : GLT_black);
+        return ret;
+}
+
+static glt_move16 glt_move_to_move16(glt_chess_board* board, glt_move move)
+{
+        /* promotion flag of the white pieces, anything that isn't a knight bishop or rook is a queen */
+        static const u8 promotions[7] = {3, 3, 3, 3, 2, 1, 0};
+        int from = glt_pos_to_index(move.start);
+        int to = glt_pos_to_index(move.end);
+        glt_piece piece = board->pieces[from];
+        glt_color color = glt_piece_color(piece);
+        int flags = board->pieces[to] != GLT_none ? GLT_move_capture : GLT_move_quiet;
+
+        if (piece == GLT__PIECE(color, GLT_white_pawn))
+        {
+                if (to == board->en_passant) flags = GLT_move_en_passant;
+                else if (to - from == 16 || from - to == 16) flags = GLT_move_double_push;
+                else if ((1ull << to) & (GLT__RANK_1 | GLT__RANK_8)) {
+                        glt_piece promotion = move.promotion;
+                        if (promotion > GLT_white_knight) promotion -= 6;
+                        flags |= GLT_move_knight_promotion | promotions[promotion];
+                }
+        }
+        else if (piece == GLT__PIECE(color, GLT_white_king) && (to - from == 2 || from - to == 2))
+        {
+                flags = to > from ? GLT_move_king_castle : GLT_move_queen_castle;
+        }
+
+        return glt_move16_encode(from, to, flags);
+}
+
+static glt_move16 glt_coords_to_move16(glt_chess_board* board, glt_coord start, glt_coord end, glt_piece promotion)
+{
+        glt_move move = {{0, 0}, {0, 0}, NULL, GLT_none};
+
+        move.start = glt_coord_to_pos(start);
+        move.end = glt_coord_to_pos(end);
+        move.promotion = promotion;
+        return glt_move_to_move16(board, move);
+}
+
+static void glt_move16_to_coords(glt_move16 move, glt_coord* start, glt_coord* end)
+{
+        *start = glt_pos_to_coord(glt_index_to_pos(glt_move16_from(move)));
+        *end = glt_pos_to_coord(glt_index_to_pos(glt_move16_to(move)));
+}
+
+/* Same as glt__move_append but for the move list, this one never allocates */
+static inline void glt__move_list_push(glt_move_list* list, int start, int end, int flags)
+{
+        assert(list->count < GLT_MAX_MOVES);
+        list->moves[list->count++] = glt_move16_encode(start, end, flags);
+}
+
+/* The 4 promotions of a pawn moving from start to end, capture is GLT_move_capture or 0 */
+static inline void glt__move_list_push_promotions(glt_move_list* list, int start, int end, int capture)
+{
+        glt__move_list_push(list, start, end, GLT_move_queen_promotion | capture);
+        glt__move_list_push(list, start, end, GLT_move_knight_promotion | capture);
+        glt__move_list_push(list, start, end, GLT_move_rook_promotion | capture);
+        glt__move_list_push(list, start, end, GLT_move_bishop_promotion | capture);
+}
+
+/* Pushes a move from start to every square in targets, the occupied ones are captures */
+static inline void glt__move_list_push_targets(glt_move_list* list, glt_chess_board* board, int start, u64 targets)
+{
+        u64 captures = targets & board->bb_occupied;
+
+        targets &= ~captures;
+        while (captures) glt__move_list_push(list, start, glt_bb_pop_lsb(&captures), GLT_move_capture);
+        while (targets) glt__move_list_push(list, start, glt_bb_pop_lsb(&targets), GLT_move_quiet);
+}
+
+/* Copies the move list to a new linked list, free it with glt_moves_delte */
+static glt_move* glt__move_list_to_linked(glt_move_list* list)
+{
+        glt_move* head = NULL;
+        glt_move** tail = &head;
+
+        for (int i = 0; i < list->count; ++i) {
+                tail = glt__move_append(tail, glt_move16_to_move(list->moves[i]));
+        }
+
+        return head;
+}
+
+
+/* 
+ * Pushes, double pushes, captures, en passant and promotions of the pawn on from
+ * En passant is only generated for the active color, the square is only valid for it
+ */
+static void glt__generate_pawn_moves(glt_chess_board* board, int from, glt_color color, int kinds, glt_move_list* list)
+{
+        u64 empty = ~board->bb_occupied;
+        u64 last_rank = color == GLT_white ? GLT__RANK_8 : GLT__RANK_1;
+
+        if (kinds & (GLT__GEN_QUIETS | GLT__GEN_PROMOTIONS))
+        {
+                /* one step forward, and a second one if the first one landed on the third rank */
+                u64 push, double_push;
+
+                if (color == GLT_white) {
+                        push = ((1ull << from) << 8) & empty;
+                        double_push = ((push & GLT__RANK_3) << 8) & empty;
+                } else {
+                        push = ((1ull << from) >> 8) & empty;
+                        double_push = ((push & GLT__RANK_6) >> 8) & empty;
+                }
+
+                if (push & last_rank) {
+                        glt__move_list_push_promotions(list, from, glt_bb_lsb(push), 0);
+                } else if (kinds & GLT__GEN_QUIETS) {
+                        if (push) glt__move_list_push(list, from, glt_bb_lsb(push), GLT_move_quiet);
+                        if (double_push) glt__move_list_push(list, from, glt_bb_lsb(double_push), GLT_move_double_push);
+                }
+        }
+
+        if (kinds & GLT__GEN_CAPTURES)
+        {
+                u64 attacks = glt_pawn_attacks(color, from);
+                u64 targets = attacks & board->bb_color[color ^ 1];
+
+                while (targets)
+                {
+                        int to = glt_bb_pop_lsb(&targets);
+
+                        if ((1ull << to) & last_rank) glt__move_list_push_promotions(list, from, to, GLT_move_capture);
+                        else glt__move_list_push(list, from, to, GLT_move_capture);
+                }
+
+                if (board->en_passant >= 0 && color == glt_active_color(board) && (attacks & (1ull << board->en_passant))) {
+                        glt__move_list_push(list, from, board->en_passant, GLT_move_en_passant);
+                }
+        }
+}
+
+/*
+ * Castling moves of the color, encoded as the king moving two squares
+ * The squares between the king and rook have to be empty and the king can't
+ * start on, pass thru or land on a attacked square
+ */
+static void glt__generate_castling(glt_chess_board* board, glt_color color, glt_move_list* list)
+{
+        glt_color them = (glt_color)(color ^ 1);
+        int king = color == GLT_white ? 4 : 60;
+        glt_piece rook = GLT__PIECE(color, GLT_white_rook);
+        glt_flags king_side = color == GLT_white ? glt_white_king_castle : glt_black_king_castle;
+        glt_flags queen_side = color == GLT_white ? glt_white_queen_castle : glt_black_queen_castle;
+
+        if (board->pieces[king] != GLT__PIECE(color, GLT_white_king)) return;
+        if (!glt__is_flag_set(board->flags, (glt_flags)(king_side | queen_side))) return;
+        if (glt__square_attacked(board, king, them)) return;
+
+        if (glt__is_flag_set(board->flags, king_side) &&
+            board->pieces[king + 3] == rook &&
+            !(board->bb_occupied & (3ull << (king + 1))) &&
+            !glt__square_attacked(board, king + 1, them) &&
+            !glt__square_attacked(board, king + 2, them))
+        {
+                glt__move_list_push(list, king, king + 2, GLT_move_king_castle);
+        }
+
+        if (glt__is_flag_set(board->flags, queen_side) &&
+            board->pieces[king - 4] == rook &&
+            !(board->bb_occupied & (7ull << (king - 3))) &&
+            !glt__square_attacked(board, king - 1, them) &&
+            !glt__square_attacked(board, king - 2, them))
+        {
+                glt__move_list_push(list, king, king - 2, GLT_move_queen_castle);
+        }
+}
+
+static int glt_generate_white_pawn_moves_list(glt_chess_board* board, glt_pos start, glt_move_list* list)
+{
+        int count = list->count;
+        GLT__TIMER_START(GLT_timer_generate_pawn);
+
+        glt__generate_pawn_moves(board, glt_pos_to_index(start), GLT_white, GLT__GEN_ALL, list);
+
+        GLT__TIMER_STOP(GLT_timer_generate_pawn);
+        GLT__COUNT(GLT_counter_moves_generated, list->count - count);
+        return list->count - count;
+}
+
+static int glt_generate_black_pawn_moves_list(glt_chess_board* board, glt_pos start, glt_move_list* list)
+{
+        int count = list->count;
+        GLT__TIMER_START(GLT_timer_generate_pawn);
+
+        glt__generate_pawn_moves(board, glt_pos_to_index(start), GLT_black, GLT__GEN_ALL, list);
+
+        GLT__TIMER_STOP(GLT_timer_generate_pawn);
+        GLT__COUNT(GLT_counter_moves_generated, list->count - count);
+        return list->count - count;
+}
+
+
+static int glt_generate_knight_moves_list(glt_chess_board* board, glt_pos start, glt_move_list* list)
+{
+        int count = list->count;
+        GLT__TIMER_START(GLT_timer_generate_knight);
+        int from = glt_pos_to_index(start);
+        u64 own = board->bb_color[glt_piece_color(board->pieces[from])];
+        u64 targets = glt_knight_attacks(from) & ~own;
+
+        glt__move_list_push_targets(list, board, from, targets);
+
+        GLT__TIMER_STOP(GLT_timer_generate_knight);
+        GLT__COUNT(GLT_counter_moves_generated, list->count - count);
+        return list->count - count;
+}
+
+static int glt_generate_rook_moves_list(glt_chess_board* board, glt_pos start, glt_move_list* list)
+{
+        int count = list->count;
+        GLT__TIMER_START(GLT_timer_generate_rook);
+        int from = glt_pos_to_index(start);
+        u64 own = board->bb_color[glt_piece_color(board->pieces[from])];
+        u64 targets = glt_rook_attacks(from, board->bb_occupied) & ~own;
+
+        glt__move_list_push_targets(list, board, from, targets);
+
+        GLT__TIMER_STOP(GLT_timer_generate_rook);
+        GLT__COUNT(GLT_counter_moves_generated, list->count - count);
+        return list->count - count;
+}
+
+static int glt_generate_bishop_moves_list(glt_chess_board* board, glt_pos start, glt_move_list* list)
+{
+        int count = list->count;
+        GLT__TIMER_START(GLT_timer_generate_bishop);
+        int from = glt_pos_to_index(start);
+        u64 own = board->bb_color[glt_piece_color(board->pieces[from])];
+        u64 targets = glt_bishop_attacks(from, board->bb_occupied) & ~own;
+
+        glt__move_list_push_targets(list, board, from, targets);
+
+        GLT__TIMER_STOP(GLT_timer_generate_bishop);
+        GLT__COUNT(GLT_counter_moves_generated, list->count - count);
+        return list->count - count;
+}
+
+static int glt_generate_king_moves_list(glt_chess_board* board, glt_pos start, glt_move_list* list)
+{
+        int count = list->count;
+        GLT__TIMER_START(GLT_timer_generate_king);
+        int from = glt_pos_to_index(start);
+        glt_color color = glt_piece_color(board->pieces[from]);
+
+        glt__move_list_push_targets(list, board, from, glt_king_attacks(from) & ~board->bb_color[color]);
+        glt__generate_castling(board, color, list);
+
+        GLT__TIMER_STOP(GLT_timer_generate_king);
+        GLT__COUNT(GLT_counter_moves_generated, list->count - count);
+        return list->count - count;
+}
+
+static int glt_generate_queen_moves_list(glt_chess_board* board, glt_pos start, glt_move_list* list)
+{
+        int count = list->count;
+        GLT__TIMER_START(GLT_timer_generate_queen);
+        int from = glt_pos_to_index(start);
+        u64 own = board->bb_color[glt_piece_color(board->pieces[from])];
+        u64 targets = glt_queen_attacks(from, board->bb_occupied) & ~own;
+
+        glt__move_list_push_targets(list, board, from, targets);
+
+        GLT__TIMER_STOP(GLT_timer_generate_queen);
+        GLT__COUNT(GLT_counter_moves_generated, list->count - count);
+        return list->count - count;
+}
+
+
+static int glt_generate_moves_list(glt_chess_board * board, glt_pos pos, glt_move_list* list) {
+        glt_piece piece = glt_piece_at_pos(board, pos);
+        switch (piece) {
+                case GLT_black_knight:
+                case GLT_white_knight:
+                        return glt_generate_knight_moves_list(board, pos, list);
+                case GLT_black_pawn:
+                        return glt_generate_black_pawn_moves_list(board, pos, list);
+                case GLT_white_pawn:
+                        return glt_generate_white_pawn_moves_list(board, pos, list);
+                case GLT_white_bishop:
+                case GLT_black_bishop:
+                        return glt_generate_bishop_moves_list(board, pos, list);
+                case GLT_white_rook:
+                case GLT_black_rook:
+                        return glt_generate_rook_moves_list(board, pos, list);
+                case GLT_black_queen:
+                case GLT_white_queen:
+                        return glt_generate_queen_moves_list(board, pos, list);
+                case GLT_black_king:
+                case GLT_white_king:
+                        return glt_generate_king_moves_list(board, pos, list);
+                default:
+                        return 0;
+        }
+}
+
+/* All the moves of the active color of the kinds, one pass over the piece sets */
+static int glt__generate_position_moves(glt_chess_board* board, int kinds, glt_move_list* list)
+{
+        int count = list->count;
+        glt_color us = glt_active_color(board);
+        u64 occupied = board->bb_occupied;
+        u64 targets = 0;
+        u64 bb;
+        GLT__TIMER_START(GLT_timer_generate_position);
+
+        if (kinds & GLT__GEN_CAPTURES) targets |= board->bb_color[us ^ 1];
+        if (kinds & GLT__GEN_QUIETS) targets |= ~occupied;
+
+        bb = board->bb_pieces[GLT__PIECE(us, GLT_white_pawn)];
+        while (bb) glt__generate_pawn_moves(board, glt_bb_pop_lsb(&bb), us, kinds, list);
+
+        bb = board->bb_pieces[GLT__PIECE(us, GLT_white_knight)];
+        while (bb) {
+                int from = glt_bb_pop_lsb(&bb);
+                glt__move_list_push_targets(list, board, from, glt_knight_attacks(from) & targets);
+        }
+
+        bb = board->bb_pieces[GLT__PIECE(us, GLT_white_bishop)];
+        while (bb) {
+                int from = glt_bb_pop_lsb(&bb);
+                glt__move_list_push_targets(list, board, from, glt_bishop_attacks(from, occupied) & targets);
+        }
+
+        bb = board->bb_pieces[GLT__PIECE(us, GLT_white_rook)];
+        while (bb) {
+                int from = glt_bb_pop_lsb(&bb);
+                glt__move_list_push_targets(list, board, from, glt_rook_attacks(from, occupied) & targets);
+        }
+
+        bb = board->bb_pieces[GLT__PIECE(us, GLT_white_queen)];
+        while (bb) {
+                int from = glt_bb_pop_lsb(&bb);
+                glt__move_list_push_targets(list, board, from, glt_queen_attacks(from, occupied) & targets);
+        }
+
+        bb = board->bb_pieces[GLT__PIECE(us, GLT_white_king)];
+        while (bb) {
+                int from = glt_bb_pop_lsb(&bb);
+                glt__move_list_push_targets(list, board, from, glt_king_attacks(from) & targets);
+        }
+
+        if (kinds & GLT__GEN_QUIETS) glt__generate_castling(board, us, list);
+
+        GLT__TIMER_STOP(GLT_timer_generate_position);
+        GLT__COUNT(GLT_counter_moves_generated, list->count - count);
+        return list->count - count;
+}
+
+static int glt_generate_all_moves(glt_chess_board* board, glt_move_list* list)
+{
+        return glt__generate_position_moves(board, GLT__GEN_ALL, list);
+}
+
+static int glt_generate_captures(glt_chess_board* board, glt_move_list* list)
+{
+        return glt__generate_position_moves(board, GLT__GEN_CAPTURES, list);
+}
+
+static int glt_generate_quiets(glt_chess_board* board, glt_move_list* list)
+{
+        return glt__generate_position_moves(board, GLT__GEN_QUIETS, list);
+}
+
+/*
+ * Does the pseudo legal move keep the king of the side to move safe, the board after the
+ * move is only worked out for the attack test instead of making the move.
+ * Castling isn't checked, the generator only emits it when the king doesn't pass an attacked square
+ */
+static inline int glt__move16_is_legal(glt_chess_board* board, glt_move16 move)
+{
+        int from = glt_move16_from(move), to = glt_move16_to(move);
+        glt_color us = glt_piece_color(board->pieces[from]);
+        u64 king = board->bb_pieces[GLT__PIECE(us, GLT_white_king)];
+        u64 removed = 1ull << to; /* the captured piece */
+        u64 occupied;
+
+        if (glt_move16_is_castle(move)) return 1;
+        if (glt_move16_flags(move) == GLT_move_en_passant) removed = 1ull << (us == GLT_white ? to - 8 : to + 8);
+
+        occupied = ((board->bb_occupied & ~removed) ^ (1ull << from)) | (1ull << to);
+        if (king & (1ull << from)) king = 1ull << to;
+        if (!king) return 1;
+
+        return !(glt__attackers_to(board, glt_bb_lsb(king), occupied) & board->bb_color[us ^ 1] & ~removed);
+}
+
+/* Where the piece on from can go without leaving the king open, the line to the king if it's pinned */
+static inline u64 glt__pin_mask(u64 pinned, int king, int from)
+{
+        return (pinned >> from) & 1 ? glt__line[king][from] : ~0ull;
+}
+
+/*
+ * The legal moves of the active color of the kinds
+ * Out of check and off the pin lines are masked out of the targets, only en passant
+ * is tested move by move as taking the pawn can open a rank to the king
+ */
+static int glt__generate_legal(glt_chess_board* board, int kinds, glt_move_list* list)
+{
+        int count = list->count;
+        glt_color us = glt_active_color(board);
+        glt_color them = (glt_color)(us ^ 1);
+        const u64* pieces = board->bb_pieces;
+        u64 own = board->bb_color[us];
+        u64 occupied = board->bb_occupied;
+        u64 king_bb = pieces[GLT__PIECE(us, GLT_white_king)];
+        u64 targets = 0, check_mask = ~0ull, pinned = 0, snipers, bb;
+        int king;
+
+        /* no king to put in check */
+        if (!king_bb) return glt__generate_position_moves(board, kinds, list);
+        king = glt_bb_lsb(king_bb);
+
+        if (kinds & GLT__GEN_CAPTURES) targets |= board->bb_color[them];
+        if (kinds & GLT__GEN_QUIETS) targets |= ~occupied;
+
+        /* the king can't go to an attacked square, it doesn't block the sliders it moves away from either */
+        bb = glt_king_attacks(king) & targets;
+        while (bb) {
+                int to = glt_bb_pop_lsb(&bb);
+                if (!(glt__attackers_to(board, to, occupied ^ king_bb) & board->bb_color[them]))
+                        glt__move_list_push(list, king, to, (occupied >> to) & 1 ? GLT_move_capture : GLT_move_quiet);
+        }
+
+        if (board->checkers)
+        {
+                /* in double check only the king can move, otherwise take the checker or block it */
+                if (board->checkers & (board->checkers - 1)) return list->count - count;
+                check_mask = board->checkers | glt__between[king][glt_bb_lsb(board->checkers)];
+                targets &= check_mask;
+        }
+        else if (kinds & GLT__GEN_QUIETS)
+        {
+                glt__generate_castling(board, us, list);
+        }
+
+        /* a piece of ours that is the only one between the king and a slider of theirs is pinned */
+        snipers = (glt_rook_attacks(king, board->bb_color[them]) & (pieces[GLT__PIECE(them, GLT_white_rook)] | pieces[GLT__PIECE(them, GLT_white_queen)]))
+                | (glt_bishop_attacks(king, board->bb_color[them]) & (pieces[GLT__PIECE(them, GLT_white_bishop)] | pieces[GLT__PIECE(them, GLT_white_queen)]));
+        while (snipers) {
+                u64 between = glt__between[king][glt_bb_pop_lsb(&snipers)] & occupied;
+                if (between && !(between & (between - 1)) && (between & own)) pinned |= between;
+        }
+
+        bb = pieces[GLT__PIECE(us, GLT_white_pawn)];
+        while (bb)
+        {
+                int from = glt_bb_pop_lsb(&bb);
+                u64 allowed = check_mask & glt__pin_mask(pinned, king, from);
+                int kept = list->count;
+
+                /* the pawn moves are generated as usual and the ones that land outside of the masks dropped */
+                glt__generate_pawn_moves(board, from, us, kinds, list);
+                for (int i = kept; i < list->count; ++i)
+                {
+                        glt_move16 move = list->moves[i];
+
+                        int legal = glt_move16_flags(move) == GLT_move_en_passant ? glt__move16_is_legal(board, move)
+                                                                                       : (int)((allowed >> glt_move16_to(move)) & 1);
+                        if (legal) list->moves[kept++] = move;
+                }
+                list->count = kept;
+        }
+
+        /* a pinned knight can never stay on the line */
+        bb = pieces[GLT__PIECE(us, GLT_white_knight)] & ~pinned;
+        while (bb) {
+                int from = glt_bb_pop_lsb(&bb);
+                glt__move_list_push_targets(list, board, from, glt_knight_attacks(from) & targets);
+        }
+
+        bb = pieces[GLT__PIECE(us, GLT_white_bishop)];
+        while (bb) {
+                int from = glt_bb_pop_lsb(&bb);
+                glt__move_list_push_targets(list, board, from, glt_bishop_attacks(from, occupied) & targets & glt__pin_mask(pinned, king, from));
+        }
+
+        bb = pieces[GLT__PIECE(us, GLT_white_rook)];
+        while (bb) {
+                int from = glt_bb_pop_lsb(&bb);
+                glt__move_list_push_targets(list, board, from, glt_rook_attacks(from, occupied) & targets & glt__pin_mask(pinned, king, from));
+        }
+
+        bb = pieces[GLT__PIECE(us, GLT_white_queen)];
+        while (bb) {
+                int from = glt_bb_pop_lsb(&bb);
+                glt__move_list_push_targets(list, board, from, glt_queen_attacks(from, occupied) & targets & glt__pin_mask(pinned, king, from));
+        }
+
+        return list->count - count;
+}
+
+static int glt__generate_legal_moves(glt_chess_board* board, int kinds, glt_move_list* list)
+{
+        GLT__TIMER_START(GLT_timer_generate_legal);
+
+        int count = glt__generate_legal(board, kinds, list);
+
+        GLT__TIMER_STOP(GLT_timer_generate_legal);
+        GLT__COUNT(GLT_counter_moves_generated, count);
+        return count;
+}
+
+static int glt_generate_legal_moves(glt_chess_board* board, glt_move_list* list)
+{
+        return glt__generate_legal_moves(board, GLT__GEN_ALL, list);
+}
+
+static int glt_generate_legal_captures(glt_chess_board* board, glt_move_list* list)
+{
+        return glt__generate_legal_moves(board, GLT__GEN_CAPTURES, list);
+}
+
+static int glt_generate_legal_quiets(glt_chess_board* board, glt_move_list* list)
+{
+        return glt__generate_legal_moves(board, GLT__GEN_QUIETS, list);
+}
+
+/* 
+ * The linked list api is built on top of the move list api,
+ * the moves are generated on the stack and then copied to the nodes
+ */
+static glt_move* glt_generate_white_pawn_moves(glt_chess_board* board, glt_pos start)
+{
+        glt_move_list list;
+        glt_move_list_clear(&list);
+        glt_generate_white_pawn_moves_list(board, start, &list);
+        return glt__move_list_to_linked(&list);
+}
+
+static glt_move* glt_generate_black_pawn_moves(glt_chess_board* board, glt_pos start)
+{
+        glt_move_list list;
+        glt_move_list_clear(&list);
+        glt_generate_black_pawn_moves_list(board, start, &list);
+        return glt__move_list_to_linked(&list);
+}
+
+static glt_move* glt_generate_knight_moves(glt_chess_board* board, glt_pos start)
+{
+        glt_move_list list;
+        glt_move_list_clear(&list);
+        glt_generate_knight_moves_list(board, start, &list);
+        return glt__move_list_to_linked(&list);
+}
+
+static glt_move* glt_generate_rook_moves(glt_chess_board* board, glt_pos start)
+{
+        glt_move_list list;
+        glt_move_list_clear(&list);
+        glt_generate_rook_moves_list(board, start, &list);
+        return glt__move_list_to_linked(&list);
+}
+
+static glt_move* glt_generate_bishop_moves(glt_chess_board* board, glt_pos start)
+{
+        glt_move_list list;
+        glt_move_list_clear(&list);
+        glt_generate_bishop_moves_list(board, start, &list);
+        return glt__move_list_to_linked(&list);
+}
+
+static glt_move* glt_generate_king_moves(glt_chess_board* board, glt_pos start)
+{
+        glt_move_list list;
+        glt_move_list_clear(&list);
+        glt_generate_king_moves_list(board, start, &list);
+        return glt__move_list_to_linked(&list);
+}
+
+static glt_move* glt_generate_queen_moves(glt_chess_board* board, glt_pos start)
+{
+        glt_move_list list;
+        glt_move_list_clear(&list);
+        glt_generate_queen_moves_list(board, start, &list);
+        return glt__move_list_to_linked(&list);
+}
+
+static glt_move* glt_generate_moves(glt_chess_board * board, glt_pos pos)
+{
+        glt_move_list list;
+        glt_move_list_clear(&list);
+        glt_generate_moves_list(board, pos, &list);
+        return glt__move_list_to_linked(&list);
+}
+
+
+/* The castling rights that are lost when a piece moves from or to the square */
+static inline u32 glt__castling_rights_lost(int square)
+{
+        switch (square) {
+                case 0:  return glt_white_queen_castle;
+                case 4:  return glt_white_queen_castle | glt_white_king_castle;
+                case 7:  return glt_white_king_castle;
+                case 56: return glt_black_queen_castle;
+                case 60: return glt_black_queen_castle | glt_black_king_castle;
+                case 63: return glt_black_king_castle;
+                default: return 0;
+        }
+}
+
+/* Makes the move without checking it, the undo record for glt_unmake_move is pushed to the history */
+static void glt__make_move(glt_chess_board* board, int from, int to, glt_piece promotion)
+{
+        glt_piece piece = board->pieces[from];
+        glt_color us = glt_piece_color(piece);
+        int is_pawn = piece == GLT__PIECE(us, GLT_white_pawn);
+        glt_history* history = board->history;
+        glt_undo scratch; /* the record goes nowhere without a history */
+        glt_undo* undo = history ? &history->moves[history->top] : &scratch;
+        GLT__TIMER_START(GLT_timer_make_move);
+
+        undo->from = (u8)from;
+        undo->to = (u8)to;
+        undo->piece = piece;
+        undo->captured = board->pieces[to];
+        undo->en_passant = board->en_passant;
+        undo->half_move_clock = board->half_move_clock;
+        undo->full_move_clock = board->full_move_clock;
+        undo->flags = board->flags;
+        undo->hash = board->hash;
+        undo->checkers = board->checkers;
+
+        if (history) {
+                history->top = (history->top + 1) & (GLT_MAX_HISTORY - 1);
+                if (history->count < GLT_MAX_HISTORY) history->count++;
+        }
+
+        if (board->en_passant >= 0) board->hash ^= glt__zobrist_en_passant[board->en_passant & 7];
+        board->en_passant = -1;
+
+        if (is_pawn)
+        {
+                if (to == undo->en_passant) {
+                        /* the captured pawn is behind the square the pawn moved to */
+                        int square = us == GLT_white ? to - 8 : to + 8;
+                        undo->captured = board->pieces[square];
+                        glt__board_remove_piece(board, square);
+                } else if (to - from == 16 || from - to == 16) {
+                        board->en_passant = (i8)((from + to) / 2);
+                        board->hash ^= glt__zobrist_en_passant[board->en_passant & 7];
+                } else if ((1ull << to) & (GLT__RANK_1 | GLT__RANK_8)) {
+                        if (promotion == GLT_none) promotion = GLT_white_queen;
+                        if (promotion > GLT_white_knight) promotion -= 6;
+                        piece = GLT__PIECE(us, promotion);
+                }
+        }
+        else if (piece == GLT__PIECE(us, GLT_white_king) && (to - from == 2 || from - to == 2))
+        {
+                /* castling, move the rook to the other side of the king */
+                int rook_from = to > from ? from + 3 : from - 4;
+                int rook_to = (from + to) / 2;
+                glt_piece rook = board->pieces[rook_from];
+
+                if (rook != GLT_none) {
+                        glt__board_remove_piece(board, rook_from);
+                        glt__board_put_piece(board, rook_to, rook);
+                }
+        }
+
+        glt__board_remove_piece(board, to);
+        glt__board_remove_piece(board, from);
+        glt__board_put_piece(board, to, piece);
+
+        board->flags &= ~(glt__castling_rights_lost(from) | glt__castling_rights_lost(to));
+        board->hash ^= glt__zobrist_castling[glt__castling_index(undo->flags)];
+        board->hash ^= glt__zobrist_castling[glt__castling_index(board->flags)];
+
+        if (is_pawn || undo->captured != GLT_none) board->half_move_clock = 0;
+        else board->half_move_clock++;
+
+        if (us == GLT_black) board->full_move_clock++;
+
+        glt__flip_flag(&board->flags, glt_flag_active_color);
+        board->hash ^= glt__zobrist_side;
+        board->checkers = glt__compute_checkers(board);
+
+        GLT__TIMER_STOP(GLT_timer_make_move);
+}
+
+/*
+ * Is the move one of the legal moves of the position, for the moves that didn't come from
+ * the generators of this position (the tt, killers, user input)
+ * It has to be one of the moves of the piece and can't leave the king in check
+ */
+static int glt__move16_is_valid(glt_chess_board* board, glt_move16 move)
+{
+        int from = glt_move16_from(move);
+        glt_piece piece = board->pieces[from];
+        glt_move_list list;
+
+        if (move == GLT_MOVE16_NONE || piece == GLT_none || !glt_piece_is_active_color(board, piece)) return 0;
+
+        glt_move_list_clear(&list);
+        glt_generate_moves_list(board, glt_index_to_pos(from), &list);
+
+        for (int i = 0; i < list.count; ++i)
+                if (list.moves[i] == move) return glt__move16_is_legal(board, move);
+        return 0;
+}
+
+static int glt_make_move(glt_chess_board* board, glt_move move){
+
+        glt_piece piece = glt_piece_at_pos(board, move.start);
+        glt_move16 move16;
+
+        assert(glt_pos_in_bounds(move.start));
+        assert(glt_pos_in_bounds(move.end));
+
+        if(piece == GLT_none) return 0;
+        if(!glt_piece_is_active_color(board, piece)) return 0;
+
+        move16 = glt_move_to_move16(board, move);
+        if (!glt__move16_is_valid(board, move16)) {
+                GLT__COUNT(GLT_counter_illegal_moves, 1);
+                return 0;
+        }
+
+        glt__make_move(board, glt_move16_from(move16), glt_move16_to(move16), glt_move16_promotion(move16, GLT_white));
+
+        return 1;
+}
+
+static inline void glt__make_move16(glt_chess_board* board, glt_move16 move)
+{
+        /* glt__make_move takes the promotion as the white piece */
+        glt__make_move(board, glt_move16_from(move), glt_move16_to(move), glt_move16_promotion(move, GLT_white));
+}
+
+static int glt_make_move16(glt_chess_board* board, glt_move16 move)
+{
+        glt_piece piece = board->pieces[glt_move16_from(move)];
+
+        if (move == GLT_MOVE16_NONE || piece == GLT_none) return 0;
+        if (!glt_piece_is_active_color(board, piece)) return 0;
+
+        glt__make_move16(board, move);
+        return 1;
+}
+
+static int glt_unmake_move(glt_chess_board* board)
+{
+        glt_history* history = board->history;
+
+        if (!history || history->count == 0) return 0;
+
+        GLT__TIMER_START(GLT_timer_unmake_move);
+        history->top = (history->top - 1) & (GLT_MAX_HISTORY - 1);
+        history->count--;
+
+        const glt_undo* undo = &history->moves[history->top];
+        glt_color us = glt_piece_color(undo->piece);
+        int from = undo->from;
+        int to = undo->to;
+
+        glt__board_remove_piece(board, to);
+        glt__board_put_piece(board, from, undo->piece);
+
+        if (undo->piece == GLT__PIECE(us, GLT_white_king) && (to - from == 2 || from - to == 2))
+        {
+                /* put the rook back in the corner */
+                int rook_from = to > from ? from + 3 : from - 4;
+                int rook_to = (from + to) / 2;
+                glt_piece rook = board->pieces[rook_to];
+
+                if (rook != GLT_none) {
+                        glt__board_remove_piece(board, rook_to);
+                        glt__board_put_piece(board, rook_from, rook);
+                }
+        }
+
+        if (undo->captured != GLT_none)
+        {
+                int square = to;
+
+                /* en passant captured the pawn behind the square */
+                if (to == undo->en_passant && undo->piece == GLT__PIECE(us, GLT_white_pawn)) {
+                        square = us == GLT_white ? to - 8 : to + 8;
+                }
+                glt__board_put_piece(board, square, undo->captured);
+        }
+
+        board->flags = undo->flags;
+        board->en_passant = undo->en_passant;
+        board->half_move_clock = undo->half_move_clock;
+        board->full_move_clock = undo->full_move_clock;
+        board->hash = undo->hash;
+        board->checkers = undo->checkers;
+
+        GLT__TIMER_STOP(GLT_timer_unmake_move);
+        return 1;
+}
+
+static int glt_board_repetitions(glt_chess_board* board)
+{
+        int count = 0;
+
+        if (!board->history) return 0;
+
+        int limit = board->half_move_clock < board->history->count ? board->half_move_clock : board->history->count;
+
+        /* the undo records keep the key of the position before the move, same side to move is every second one */
+        for (int n = 1; n < limit; n += 2) {
+                if (glt_board_history(board, n)->hash == board->hash) count++;
+        }
+        return count;
+}
+
+static const glt_undo* glt_board_history(glt_chess_board* board, int n)
+{
+        if (!board->history || n < 0 || n >= board->history->count) return NULL;
+        return &board->history->moves[(board->history->top - 1 - n) & (GLT_MAX_HISTORY - 1)];
+}
+
+static void glt_board_set_history(glt_chess_board* board, glt_history* history)
+{
+        board->history = history;
+        if (history) {
+                history->top = 0;
+                history->count = 0;
+        }
+}
+
+/* Piece of a fen char, GLT_none if it isn't one */
+static inline glt_piece glt__piece_from_fen_char(char c)
+{
+        switch (c) {
+                case 'P': return GLT_white_pawn;
+                case 'K': return GLT_white_king;
+                case 'Q': return GLT_white_queen;
+                case 'R': return GLT_white_rook;
+                case 'B': return GLT_white_bishop;
+                case 'N': return GLT_white_knight;
+                case 'p': return GLT_black_pawn;
+                case 'k': return GLT_black_king;
+                case 'q': return GLT_black_queen;
+                case 'r': return GLT_black_rook;
+                case 'b': return GLT_black_bishop;
+                case 'n': return GLT_black_knight;
+                default:  return GLT_none;
+        }
+}
+
+/* Reads a number that is at most max, returns NULL if there isn't one */
+static const char* glt__fen_read_number(const char* fen, u32 max, u32* value)
+{
+        u32 number = 0;
+
+        if (*fen < '0' || *fen > '9') return NULL;
+
+        while (*fen >= '0' && *fen <= '9') {
+                number = number * 10 + (u32)(*fen++ - '0');
+                if (number > max) return NULL;
+        }
+        *value = number;
+        return fen;
+}
+
+static inline int glt__fen_field_end(char c)
+{
+        return c == ' ' || c == '\0' || c == '\n' || c == '\r';
+}
+
+/* Empty board with no history, the pieces go on it with glt__board_put_piece */
+static void glt__board_clear(glt_chess_board* board)
+{
+        glt_init_tables();
+
+        for (int i = 0; i < 64; ++i) board->pieces[i] = GLT_none;
+        for (int i = 0; i < 13; ++i) board->bb_pieces[i] = 0;
+        board->bb_pieces[GLT_none] = ~0ull;
+        board->bb_color[GLT_white] = 0;
+        board->bb_color[GLT_black] = 0;
+        board->bb_occupied = 0;
+        board->hash = 0;
+        board->checkers = 0;
+        board->psq = 0;
+        board->phase = 0;
+        board->flags = 0;
+        board->en_passant = -1;
+        board->half_move_clock = 0;
+        board->full_move_clock = 1;
+        board->history = NULL;
+}
+
+/* The hash of a board set up with glt__board_clear and glt__board_put_piece only has the pieces */
+static inline void glt__board_hash_state(glt_chess_board* board)
+{
+        board->hash ^= glt__zobrist_castling[glt__castling_index(board->flags)];
+        if (board->en_passant >= 0) board->hash ^= glt__zobrist_en_passant[board->en_passant & 7];
+        if (!glt__is_flag_set(board->flags, glt_flag_active_color)) board->hash ^= glt__zobrist_side;
+}
+
+static glt_fen_error glt__parse_fen(glt_chess_board *board, const char* fen)
+{
+        int rank = 7, file = 0;
+
+        glt__board_clear(board);
+
+        /* piece placement, starts at a8 */
+        for (; !glt__fen_field_end(*fen); fen++)
+        {
+                char c = *fen;
+
+                if (c == '/') {
+                        if (file != 8 || rank == 0) return GLT_fen_error_placement;
+                        rank--;
+                        file = 0;
+                } else if (c >= '1' && c <= '8') {
+                        file += c - '0';
+                        if (file > 8) return GLT_fen_error_placement;
+                } else {
+                        glt_piece piece = glt__piece_from_fen_char(c);
+                        if (piece == GLT_none || file >= 8) return GLT_fen_error_placement;
+                        glt__board_put_piece(board, rank * 8 + file++, piece);
+                }
+        }
+        if (rank != 0 || file != 8) return GLT_fen_error_placement;
+
+        if (glt_bb_popcount(board->bb_pieces[GLT_white_king]) != 1 ||
+            glt_bb_popcount(board->bb_pieces[GLT_black_king]) != 1) return GLT_fen_error_kings;
+
+        /* active color */
+        if (*fen++ != ' ') return GLT_fen_error_active_color;
+        if (*fen == 'w') glt__flag_set(&board->flags, glt_flag_active_color);
+        else if (*fen != 'b') return GLT_fen_error_active_color;
+        fen++;
+        if (*fen++ != ' ') return GLT_fen_error_active_color;
+
+        /* castling */
+        if (*fen == '-') {
+                fen++;
+        } else {
+                const char* start = fen;
+                for (; !glt__fen_field_end(*fen); fen++) {
+                        switch (*fen) {
+                                case 'K': glt__flag_set(&board->flags, glt_white_king_castle); break;
+                                case 'Q': glt__flag_set(&board->flags, glt_white_queen_castle); break;
+                                case 'k': glt__flag_set(&board->flags, glt_black_king_castle); break;
+                                case 'q': glt__flag_set(&board->flags, glt_black_queen_castle); break;
+                                default: return GLT_fen_error_castling;
+                        }
+                }
+                if (fen == start) return GLT_fen_error_castling;
+        }
+        if (*fen++ != ' ') return GLT_fen_error_castling;
+
+        /* en passant */
+        if (*fen == '-') {
+                fen++;
+        } else {
+                int ep_rank = glt__is_flag_set(board->flags, glt_flag_active_color) ? '6' : '3';
+                if (fen[0] < 'a' || fen[0] > 'h' || fen[1] != ep_rank) return GLT_fen_error_en_passant;
+                board->en_passant = (i8)((fen[0] - 'a') + (fen[1] - '1') * 8);
+                fen += 2;
+        }
+        if (!glt__fen_field_end(*fen)) return GLT_fen_error_en_passant;
+
+        /* clocks, both are optional */
+        if (*fen == ' ' && fen[1] >= '0' && fen[1] <= '9')
+        {
+                u32 half, full;
+
+                fen = glt__fen_read_number(fen + 1, 255, &half);
+                if (!fen || *fen != ' ') return GLT_fen_error_clock;
+
+                fen = glt__fen_read_number(fen + 1, 65535, &full);
+                if (!fen || !glt__fen_field_end(*fen)) return GLT_fen_error_clock;
+
+                board->half_move_clock = (u8)half;
+                board->full_move_clock = (u16)(full ? full : 1);
+        }
+
+        glt__board_hash_state(board);
+        board->checkers = glt__compute_checkers(board);
+
+        return GLT_fen_ok;
+}
+
+static glt_fen_error glt_set_board_from_fen(glt_chess_board *board, const char* fen)
+{
+        GLT__TIMER_START(GLT_timer_fen_parse);
+
+        glt_fen_error error = glt__parse_fen(board, fen);
+
+        GLT__TIMER_STOP(GLT_timer_fen_parse);
+        return error;
+}
+
+static const char* glt_fen_error_string(glt_fen_error error)
+{
+        switch (error) {
+                case GLT_fen_ok:                 return "ok";
+                case GLT_fen_error_placement:    return "invalid piece placement";
+                case GLT_fen_error_kings:        return "each side needs exactly one king";
+                case GLT_fen_error_active_color: return "active color has to be w or b";
+                case GLT_fen_error_castling:     return "invalid castling rights";
+                case GLT_fen_error_en_passant:   return "invalid en passant square";
+                case GLT_fen_error_clock:        return "invalid half move or full move clock";
+                default:                         return "unknown error";
+        }
+}
+
+static inline void glt__store_le32(u8* out, u32 value)
+{
+        out[0] = (u8)value;
+        out[1] = (u8)(value >> 8);
+        out[2] = (u8)(value >> 16);
+        out[3] = (u8)(value >> 24);
+}
+
+static inline u32 glt__load_le32(const u8* in)
+{
+        return (u32)in[0] | ((u32)in[1] << 8) | ((u32)in[2] << 16) | ((u32)in[3] << 24);
+}
+
+static inline u64 glt__load_le64(const u8* in)
+{
+        return (u64)glt__load_le32(in) | ((u64)glt__load_le32(in + 4) << 32);
+}
+
+static void glt_pack_position(glt_chess_board* board, glt_packed_position* packed)
+{
+        u64 occupied = board->bb_occupied;
+        int n = 0;
+
+        glt__store_le32(packed->occupied, (u32)occupied);
+        glt__store_le32(packed->occupied + 4, (u32)(occupied >> 32));
+
+        for (int i = 0; i < 16; ++i) packed->pieces[i] = 0;
+
+        /* only the first 32 pieces fit, a legal position doesn't have more */
+        while (occupied && n < 32) {
+                int square = glt_bb_pop_lsb(&occupied);
+                packed->pieces[n >> 1] |= (u8)(board->pieces[square] << ((n & 1) * 4));
+                n++;
+        }
+
+        packed->state = (u8)glt__castling_index(board->flags);
+        if (glt_active_color(board) == GLT_black) packed->state |= 16;
+        packed->en_passant = board->en_passant >= 0 ? (u8)board->en_passant : 255;
+        packed->half_move_clock = board->half_move_clock;
+        packed->full_move_clock[0] = (u8)board->full_move_clock;
+        packed->full_move_clock[1] = (u8)(board->full_move_clock >> 8);
+        packed->reserved[0] = 0;
+        packed->reserved[1] = 0;
+        packed->reserved[2] = 0;
+}
+
+static int glt_unpack_position(const glt_packed_position* packed, glt_chess_board* board)
+{
+        u64 occupied = glt__load_le64(packed->occupied);
+        int n = 0;
+
+        if (glt_bb_popcount(occupied) > 32 || packed->state > 31) return 0;
+
+        glt__board_clear(board);
+
+        while (occupied)
+        {
+                int square = glt_bb_pop_lsb(&occupied);
+                glt_piece piece = (glt_piece)((packed->pieces[n >> 1] >> ((n & 1) * 4)) & 15);
+
+                if (piece == GLT_none || piece > GLT_black_knight) return 0;
+                glt__board_put_piece(board, square, piece);
+                n++;
+        }
+
+        if (glt_bb_popcount(board->bb_pieces[GLT_white_king]) != 1 ||
+            glt_bb_popcount(board->bb_pieces[GLT_black_king]) != 1) return 0;
+
+        board->flags = (u32)(packed->state & 15) << 2;
+        if (!(packed->state & 16)) glt__flag_set(&board->flags, glt_flag_active_color);
+        /* the pawn that just moved two squares is in front of the en passant square and the squares it crossed are empty */
+        if (packed->en_passant != 255)
+        {
+                int white = !(packed->state & 16);
+                int ep = packed->en_passant;
+                int forward = white ? -8 : 8;
+
+                if ((ep >> 3) != (white ? 5 : 2)) return 0;
+                if (board->pieces[ep + forward] != (white ? GLT_black_pawn : GLT_white_pawn)) return 0;
+                if (board->pieces[ep] != GLT_none || board->pieces[ep - forward] != GLT_none) return 0;
+        }
+        board->en_passant = packed->en_passant == 255 ? -1 : (i8)packed->en_passant;
+        board->half_move_clock = packed->half_move_clock;
+        board->full_move_clock = (u16)(packed->full_move_clock[0] | (packed->full_move_clock[1] << 8));
+
+        glt__board_hash_state(board);
+        board->checkers = glt__compute_checkers(board);
+        return 1;
+}
+
+#ifndef GLT_CHESS_NO_STDIO
+#define GLT__PACKED_HEADER_SIZE 16
+
+/* FNV-1a over 8 bytes at a time, the positions are a multiple of 8 bytes */
+static u32 glt__packed_checksum(const glt_packed_position* positions, u32 count)
+{
+        const u8* data = (const u8*)positions;
+        size_t size = (size_t)count * sizeof(glt_packed_position);
+        u64 hash = 0xcbf29ce484222325ull;
+
+        for (size_t i = 0; i < size; i += 8) hash = (hash ^ glt__load_le64(data + i)) * 0x100000001b3ull;
+
+        return (u32)(hash ^ (hash >> 32));
+}
+
+static int glt__packed_flush(glt_packed_writer* writer)
+{
+        u8 header[GLT__PACKED_HEADER_SIZE] = {'G', 'L', 'T', 'P', GLT_PACKED_VERSION, 0, 0, 0};
+
+        if (writer->count == 0) return !writer->error;
+
+        glt__store_le32(header + 8, writer->count);
+        glt__store_le32(header + 12, glt__packed_checksum(writer->block, writer->count));
+
+        if (fwrite(header, 1, sizeof(header), writer->file) != sizeof(header) ||
+            fwrite(writer->block, sizeof(glt_packed_position), writer->count, writer->file) != writer->count) {
+                writer->error = 1;
+        }
+
+        writer->count = 0;
+        return !writer->error;
+}
+
+static int glt_packed_writer_open(glt_packed_writer* writer, const char* path)
+{
+        writer->count = 0;
+        writer->error = 0;
+        writer->block = (glt_packed_position*)GLT_malloc(sizeof(glt_packed_position) * GLT_PACKED_BLOCK_POSITIONS);
+        writer->file = writer->block ? fopen(path, "ab") : NULL;
+
+        if (!writer->file) {
+                if (writer->block) GLT_free(writer->block);
+                writer->block = NULL;
+                return 0;
+        }
+        return 1;
+}
+
+static int glt_packed_write_packed(glt_packed_writer* writer, const glt_packed_position* packed)
+{
+        writer->block[writer->count++] = *packed;
+        if (writer->count == GLT_PACKED_BLOCK_POSITIONS) return glt__packed_flush(writer);
+        return !writer->error;
+}
+
+static int glt_packed_write(glt_packed_writer* writer, glt_chess_board* board)
+{
+        glt_pack_position(board, &writer->block[writer->count++]);
+        if (writer->count == GLT_PACKED_BLOCK_POSITIONS) return glt__packed_flush(writer);
+        return !writer->error;
+}
+
+static int glt_packed_writer_close(glt_packed_writer* writer)
+{
+        if (!writer->file) return 0;
+
+        glt__packed_flush(writer);
+        if (fclose(writer->file) != 0) writer->error = 1;
+
+        GLT_free(writer->block);
+        writer->file = NULL;
+        writer->block = NULL;
+        return !writer->error;
+}
+
+static int glt_packed_reader_open(glt_packed_reader* reader, const char* path)
+{
+        reader->count = 0;
+        reader->next = 0;
+        reader->error = 0;
+        reader->block = (glt_packed_position*)GLT_malloc(sizeof(glt_packed_position) * GLT_PACKED_BLOCK_POSITIONS);
+        reader->file = reader->block ? fopen(path, "rb") : NULL;
+
+        if (!reader->file) {
+                if (reader->block) GLT_free(reader->block);
+                reader->block = NULL;
+                return 0;
+        }
+        return 1;
+}
+
+/* Reads the next block, returns 0 at the end of the file or if the block is damaged */
+static int glt__packed_read_next(glt_packed_reader* reader)
+{
+        u8 header[GLT__PACKED_HEADER_SIZE];
+        size_t read;
+
+        reader->count = 0;
+        reader->next = 0;
+
+        if (reader->error) return 0;
+
+        read = fread(header, 1, sizeof(header), reader->file);
+        if (read == 0 && feof(reader->file)) return 0;
+
+        u32 count = read == sizeof(header) ? glt__load_le32(header + 8) : 0;
+
+        if (count == 0 || count > GLT_PACKED_BLOCK_POSITIONS || header[0] != 'G' || header[1] != 'L' ||
+            header[2] != 'T' || header[3] != 'P' || header[4] != GLT_PACKED_VERSION ||
+            fread(reader->block, sizeof(glt_packed_position), count, reader->file) != count ||
+            glt__packed_checksum(reader->block, count) != glt__load_le32(header + 12))
+        {
+                reader->error = 1;
+                return 0;
+        }
+
+        reader->count = count;
+        return 1;
+}
+
+static u32 glt_packed_read_block(glt_packed_reader* reader, const glt_packed_position** positions)
+{
+        if (reader->next == reader->count && !glt__packed_read_next(reader)) return 0;
+
+        u32 count = reader->count - reader->next;
+
+        *positions = reader->block + reader->next;
+        reader->next = reader->count;
+        return count;
+}
+
+static int glt_packed_read(glt_packed_reader* reader, glt_chess_board* board)
+{
+        if (reader->next == reader->count && !glt__packed_read_next(reader)) return 0;
+
+        if (!glt_unpack_position(&reader->block[reader->next++], board)) {
+                reader->error = 1;
+                return 0;
+        }
+        return 1;
+}
+
+static void glt_packed_reader_close(glt_packed_reader* reader)
+{
+        if (reader->file) fclose(reader->file);
+        if (reader->block) GLT_free(reader->block);
+        reader->file = NULL;
+        reader->block = NULL;
+}
+#endif
+
+static char glt_get_fen_char(glt_piece piece ) {
+  switch (piece) {
+    case GLT_white_pawn:
+      return 'P';
+    case GLT_white_king:
+      return 'K';
+    case GLT_white_queen:
+      return 'Q';
+    case GLT_white_rook:
+      return 'R';
+    case GLT_white_bishop:
+      return 'B';
+    case GLT_white_knight:
+      return 'N';
+    case GLT_black_pawn:
+      return 'p';
+    case GLT_black_king:
+      return 'k';
+    case GLT_black_queen:
+      return 'q';
+    case GLT_black_rook:
+      return 'r';
+    case GLT_black_bishop:
+      return 'b';
+    case GLT_black_knight:
+      return 'n';
+    case GLT_none:
+      return '-';  // Placeholder for empty square
+    default:
+      return '-';
+  }
+}
+
+/* "00" to "99", two chars per number */
+static const char glt__digit_pairs[201] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+
+/* Writes the number without leading zeros, returns the number of chars */
+static inline int glt__write_u16(char* out, u32 value)
+{
+        char buffer[5];
+        int len = 0;
+
+        while (value >= 100) {
+                u32 pair = (value % 100) * 2;
+                value /= 100;
+                buffer[4 - len++] = glt__digit_pairs[pair + 1];
+                buffer[4 - len++] = glt__digit_pairs[pair];
+        }
+        if (value >= 10) {
+                buffer[4 - len++] = glt__digit_pairs[value * 2 + 1];
+                buffer[4 - len++] = glt__digit_pairs[value * 2];
+        } else {
+                buffer[4 - len++] = (char)('0' + value);
+        }
+
+        for (int i = 0; i < len; ++i) out[i] = buffer[5 - len + i];
+        return len;
+}
+
+/* Writes the fen without the null, out needs GLT_MAX_FEN_LENGTH - 1 chars */
+static int glt__write_fen(glt_chess_board* board, char* out)
+{
+        static const char piece_chars[13] = {' ', 'P', 'K', 'Q', 'R', 'B', 'N', 'p', 'k', 'q', 'r', 'b', 'n'};
+        char* fen = out;
+        GLT__TIMER_START(GLT_timer_fen_write);
+
+        /* ranks from 8 to 1, files from a to h */
+        for (int rank = 7; rank >= 0; rank--)
+        {
+                const glt_piece* pieces = &board->pieces[rank * 8];
+                int empty_count = 0;
+
+                for (int file = 0; file < 8; file++)
+                {
+                        glt_piece piece = pieces[file];
+
+                        if (piece == GLT_none) {
+                                empty_count++;
+                                continue;
+                        }
+                        if (empty_count) {
+                                *fen++ = (char)('0' + empty_count);
+                                empty_count = 0;
+                        }
+                        *fen++ = piece_chars[piece];
+                }
+                if (empty_count) *fen++ = (char)('0' + empty_count);
+                if (rank) *fen++ = '/';
+        }
+
+        *fen++ = ' ';
+        *fen++ = glt__is_flag_set(board->flags, glt_flag_active_color) ? 'w' : 'b';
+        *fen++ = ' ';
+
+        if (glt__castling_index(board->flags) == 0) {
+                *fen++ = '-';
+        } else {
+                if (glt__is_flag_set(board->flags, glt_white_king_castle))  *fen++ = 'K';
+                if (glt__is_flag_set(board->flags, glt_white_queen_castle)) *fen++ = 'Q';
+                if (glt__is_flag_set(board->flags, glt_black_king_castle))  *fen++ = 'k';
+                if (glt__is_flag_set(board->flags, glt_black_queen_castle)) *fen++ = 'q';
+        }
+
+        *fen++ = ' ';
+        if (board->en_passant >= 0) {
+                *fen++ = (char)('a' + (board->en_passant & 7));
+                *fen++ = (char)('1' + (board->en_passant >> 3));
+        } else {
+                *fen++ = '-';
+        }
+
+        *fen++ = ' ';
+        fen += glt__write_u16(fen, board->half_move_clock);
+        *fen++ = ' ';
+        fen += glt__write_u16(fen, board->full_move_clock);
+
+        GLT__TIMER_STOP(GLT_timer_fen_write);
+        return (int)(fen - out);
+}
+
+static int glt_get_fen_from_board(glt_chess_board *board, char* fen, int len)
+{
+        char buffer[GLT_MAX_FEN_LENGTH];
+        int length;
+
+        if (len >= GLT_MAX_FEN_LENGTH) {
+                length = glt__write_fen(board, fen);
+                fen[length] = '\0';
+                return length;
+        }
+
+        /* might not fit, write it to the stack first */
+        length = glt__write_fen(board, buffer);
+        if (length + 1 > len) return 0;
+
+        for (int i = 0; i < length; ++i) fen[i] = buffer[i];
+        fen[length] = '\0';
+        return length;
+}
+
+static int glt_get_fen_batch(glt_chess_board** boards, int count, char* out, size_t capacity, size_t* bytes_written)
+{
+        char buffer[GLT_MAX_FEN_LENGTH];
+        size_t used = 0;
+        int i;
+
+        for (i = 0; i < count; ++i)
+        {
+                /* the fen and the new line */
+                if (capacity - used >= GLT_MAX_FEN_LENGTH) {
+                        used += (size_t)glt__write_fen(boards[i], out + used);
+                } else {
+                        size_t length = (size_t)glt__write_fen(boards[i], buffer);
+                        if (length + 1 > capacity - used) break;
+                        for (size_t j = 0; j < length; ++j) out[used + j] = buffer[j];
+                        used += length;
+                }
+                out[used++] = '\n';
+        }
+
+        if (bytes_written) *bytes_written = used;
+        return i;
+}
+
+static int glt_move_to_string(glt_move move, char* str)
+{
+        int len = 0;
+
+        str[len++] = 'a' + move.start.x - 1;
+        str[len++] = '0' + move.start.y;
+        str[len++] = 'a' + move.end.x - 1;
+        str[len++] = '0' + move.end.y;
+
+        /* lower case piece char, the color is known from the rank */
+        if (move.promotion != GLT_none) str[len++] = glt_get_fen_char(GLT__PIECE(GLT_black, (move.promotion - 1) % 6 + 1));
+
+        str[len] = '\0';
+        return len;
+}
+
+static int glt_move16_to_string(glt_move16 move, char* str)
+{
+        static const char promotions[4] = {'n', 'b', 'r', 'q'};
+        int from = glt_move16_from(move), to = glt_move16_to(move);
+        int len = 0;
+
+        str[len++] = 'a' + (from & 7);
+        str[len++] = '1' + (from >> 3);
+        str[len++] = 'a' + (to & 7);
+        str[len++] = '1' + (to >> 3);
+
+        if (glt_move16_is_promotion(move)) str[len++] = promotions[glt_move16_flags(move) & 3];
+
+        str[len] = '\0';
+        return len;
+}
+
+/* Is the king of the color attacked */
+static inline int glt__king_attacked(glt_chess_board* board, glt_color color)
+{
+        u64 king = board->bb_pieces[GLT__PIECE(color, GLT_white_king)];
+        return king && glt__square_attacked(board, glt_bb_lsb(king), (glt_color)(color ^ 1));
+}
+
+/* Can the side to move make a move */
+static int glt__has_legal_move(glt_chess_board* board)
+{
+        glt_move_list list;
+
+        glt_move_list_clear(&list);
+        return glt_generate_legal_moves(board, &list) != 0;
+}
+
+static const char glt__san_pieces[7] = {0, 0, 'K', 'Q', 'R', 'B', 'N'};
+
+/* The white piece of a san piece letter, GLT_none if it isn't one */
+static inline glt_piece glt__san_piece(char c)
+{
+        switch (c) {
+                case 'K': return GLT_white_king;
+                case 'Q': return GLT_white_queen;
+                case 'R': return GLT_white_rook;
+                case 'B': return GLT_white_bishop;
+                case 'N': return GLT_white_knight;
+                default:  return GLT_none;
+        }
+}
+
+static int glt_move16_to_san(glt_chess_board* board, glt_move16 move, char* str)
+{
+        int from = glt_move16_from(move), to = glt_move16_to(move);
+        glt_piece piece = board->pieces[from];
+        glt_color us = glt_piece_color(piece);
+        glt_piece kind = (glt_piece)(piece - 6 * us); /* the white piece */
+        int len = 0;
+
+        if (glt_move16_is_castle(move))
+        {
+                str[len++] = 'O'; str[len++] = '-'; str[len++] = 'O';
+                if (glt_move16_flags(move) == GLT_move_queen_castle) { str[len++] = '-'; str[len++] = 'O'; }
+        }
+        else
+        {
+                if (kind == GLT_white_pawn)
+                {
+                        if (glt_move16_is_capture(move)) str[len++] = 'a' + (from & 7);
+                }
+                else
+                {
+                        /* the other pieces of the kind that can go to the square as well */
+                        u64 others = glt__piece_attackers(board, piece, to) & ~(1ull << from);
+                        u64 ambiguous = 0;
+
+                        while (others) {
+                                int other = glt_bb_pop_lsb(&others);
+                                if (glt__move16_is_legal(board, glt_move16_encode(other, to, glt_move16_flags(move))))
+                                        ambiguous |= 1ull << other;
+                        }
+
+                        str[len++] = glt__san_pieces[kind];
+                        if (ambiguous) {
+                                u64 file = 0x0101010101010101ull << (from & 7);
+                                u64 rank = 0xffull << (from & ~7);
+
+                                if (!(ambiguous & file)) str[len++] = 'a' + (from & 7);
+                                else if (!(ambiguous & rank)) str[len++] = '1' + (from >> 3);
+                                else { str[len++] = 'a' + (from & 7); str[len++] = '1' + (from >> 3); }
+                        }
+                }
+
+                if (glt_move16_is_capture(move)) str[len++] = 'x';
+                str[len++] = 'a' + (to & 7);
+                str[len++] = '1' + (to >> 3);
+
+                if (glt_move16_is_promotion(move)) {
+                        str[len++] = '=';
+                        str[len++] = glt__san_pieces[glt_move16_promotion(move, GLT_white)];
+                }
+        }
+
+        /* the check marks are worked out on a copy, the board might not have a history to take the move back */
+        glt_chess_board after = *board;
+
+        after.history = NULL;
+        glt__make_move16(&after, move);
+        if (glt_in_check(&after)) str[len++] = glt__has_legal_move(&after) ? '+' : '#';
+
+        str[len] = '\0';
+        return len;
+}
+
+static glt_move16 glt_move16_from_san(glt_chess_board* board, const char* san, size_t length)
+{
+        glt_color us = glt_active_color(board);
+        glt_piece piece = GLT_white_pawn, promotion = GLT_none;
+        int from_file = -1, from_rank = -1, capture = 0;
+        int flags, to;
+        u64 candidates;
+        size_t i = 0;
+
+        while (length > 0 && (san[length - 1] == '+' || san[length - 1] == '#' || san[length - 1] == '!' || san[length - 1] == '?')) length--;
+
+        /* O-O and O-O-O, some write it with zeros */
+        if (length >= 3 && (san[0] == 'O' || san[0] == '0'))
+        {
+                glt_move_list list;
+                int castle;
+
+                if (length == 3 && san[1] == '-' && san[2] == san[0]) castle = GLT_move_king_castle;
+                else if (length == 5 && san[1] == '-' && san[2] == san[0] && san[3] == '-' && san[4] == san[0]) castle = GLT_move_queen_castle;
+                else return GLT_MOVE16_NONE;
+
+                glt_move_list_clear(&list);
+                glt__generate_castling(board, us, &list);
+                for (int j = 0; j < list.count; ++j)
+                        if (glt_move16_flags(list.moves[j]) == castle) return list.moves[j];
+                return GLT_MOVE16_NONE;
+        }
+
+        if (length > 0 && glt__san_piece(san[0]) != GLT_none) piece = glt__san_piece(san[i++]);
+
+        /* promotion, e8=Q or e8Q */
+        if (piece == GLT_white_pawn && length >= 3 && glt__san_piece(san[length - 1]) != GLT_none)
+        {
+                promotion = glt__san_piece(san[--length]);
+                if (san[length - 1] == '=') length--;
+                if (promotion == GLT_white_king) return GLT_MOVE16_NONE;
+        }
+
+        if (length < i + 2) return GLT_MOVE16_NONE;
+
+        char file = san[length - 2], rank = san[length - 1];
+        if (file < 'a' || file > 'h' || rank < '1' || rank > '8') return GLT_MOVE16_NONE;
+        to = (file - 'a') + (rank - '1') * 8;
+
+        /* what's between the piece and the square, the start file and or rank and the capture */
+        for (; i < length - 2; ++i)
+        {
+                char c = san[i];
+
+                if (c >= 'a' && c <= 'h') from_file = c - 'a';
+                else if (c >= '1' && c <= '8') from_rank = c - '1';
+                else if (c == 'x' || c == ':') capture = 1;
+                else if (c != '-') return GLT_MOVE16_NONE;
+        }
+
+        if (board->bb_color[us] & (1ull << to)) return GLT_MOVE16_NONE;
+        flags = board->bb_color[us ^ 1] & (1ull << to) ? GLT_move_capture : GLT_move_quiet;
+
+        if (piece == GLT_white_pawn)
+        {
+                glt_piece pawn = GLT__PIECE(us, GLT_white_pawn);
+                int behind = us == GLT_white ? to - 8 : to + 8;
+
+                if (from_file >= 0 && from_file != (to & 7)) {
+                        candidates = glt__piece_attackers(board, pawn, to);
+                        if (to == board->en_passant) flags = GLT_move_en_passant;
+                        else if (flags != GLT_move_capture) return GLT_MOVE16_NONE;
+                } else {
+                        /* a push, one step or two from the start rank */
+                        if (flags != GLT_move_quiet || capture || behind < 0 || behind > 63) return GLT_MOVE16_NONE;
+
+                        if (board->pieces[behind] == pawn) {
+                                candidates = 1ull << behind;
+                        } else if (board->pieces[behind] == GLT_none && (1ull << behind) & (us == GLT_white ? GLT__RANK_3 : GLT__RANK_6) &&
+                                   board->pieces[behind * 2 - to] == pawn) {
+                                candidates = 1ull << (behind * 2 - to);
+                                flags = GLT_move_double_push;
+                        } else {
+                                return GLT_MOVE16_NONE;
+                        }
+                }
+
+                /* a pawn that gets to the last rank has to say what it promotes to */
+                if (((1ull << to) & (GLT__RANK_1 | GLT__RANK_8)) ? promotion == GLT_none : promotion != GLT_none) return GLT_MOVE16_NONE;
+
+                /* the promotion flags go knight, bishop, rook, queen which is the white pieces backwards */
+                if (promotion != GLT_none) flags |= GLT_move_knight_promotion | (GLT_white_knight - promotion);
+        }
+        else
+        {
+                candidates = glt__piece_attackers(board, GLT__PIECE(us, piece), to);
+        }
+
+        if (from_file >= 0) candidates &= 0x0101010101010101ull << from_file;
+        if (from_rank >= 0) candidates &= 0xffull << (from_rank * 8);
+
+        glt_move16 found = GLT_MOVE16_NONE;
+        while (candidates)
+        {
+                glt_move16 move = glt_move16_encode(glt_bb_pop_lsb(&candidates), to, flags);
+
+                if (glt__move16_is_legal(board, move)) {
+                        if (found != GLT_MOVE16_NONE) return GLT_MOVE16_NONE;
+                        found = move;
+                }
+        }
+        return found;
+}
+
+static u64 glt__perft(glt_chess_board* board, int depth)
+{
+        if (depth <= 0) return 1;
+
+        glt_move_list list;
+        u64 nodes = 0;
+
+        glt_move_list_clear(&list);
+        glt_generate_legal_moves(board, &list);
+
+        /* the moves are legal so the last ply is just the count */
+        if (depth == 1) return (u64)list.count;
+
+        for (int i = 0; i < list.count; ++i)
+        {
+                glt__make_move16(board, list.moves[i]);
+                nodes += glt__perft(board, depth - 1);
+                glt_unmake_move(board);
+        }
+        return nodes;
+}
+
+/* perft works on a copy of the board with its own history, the board might not have one */
+static u64 glt_perft(glt_chess_board* board, int depth)
+{
+        glt_chess_board copy = *board;
+        glt_history history;
+
+        glt_board_set_history(&copy, &history);
+        return glt__perft(&copy, depth);
+}
+
+static u64 glt_perft_divide(glt_chess_board* board, int depth, glt_move_list* moves, u64* counts)
+{
+        glt_chess_board copy = *board;
+        glt_history history;
+        u64 nodes = 0;
+
+        glt_board_set_history(&copy, &history);
+        glt_move_list_clear(moves);
+        glt_generate_legal_moves(&copy, moves);
+
+        for (int i = 0; i < moves->count; ++i)
+        {
+                glt__make_move16(&copy, moves->moves[i]);
+                counts[i] = glt__perft(&copy, depth - 1);
+                nodes += counts[i];
+                glt_unmake_move(&copy);
+        }
+        return nodes;
+}
+
+/* 
+ * Relaxed atomic loads and stores for the data shared between threads
+ * Torn or stale values are fine, the users of these check the data they read
+ */
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define GLT__LOAD_RELAXED(ptr) (*(volatile u64*)(ptr))
+#define GLT__STORE_RELAXED(ptr, value) (*(volatile u64*)(ptr) = (value))
+#define GLT__FETCH_ADD(ptr, value) ((u64)_InterlockedExchangeAdd64((volatile __int64*)(ptr), (__int64)(value)))
+#else
+#define GLT__LOAD_RELAXED(ptr) __atomic_load_n((ptr), __ATOMIC_RELAXED)
+#define GLT__STORE_RELAXED(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELAXED)
+#define GLT__FETCH_ADD(ptr, value) __atomic_fetch_add((ptr), (value), __ATOMIC_RELAXED)
+#endif
+
+/* 
+ * Layout of the tt data
+ * bits 0 to 15 the glt_move16
+ * bits 16 to 31 the score
+ * bits 32 to 39 the depth
+ * bits 40 to 41 the bound
+ * bits 42 to 47 the generation
+ * bit 48 is always set so a used entry is never 0
+ */
+#define GLT__TT_GENERATION_MASK 63
+
+
+static int glt_tt_create(glt_tt* tt, size_t megabytes)
+{
+        u64 bytes = (u64)megabytes << 20;
+        u64 count = 1;
+
+        while (count * 2 * sizeof(glt__tt_bucket) <= bytes) count *= 2;
+
+        tt->memory = GLT_malloc((size_t)(count * sizeof(glt__tt_bucket) + 63));
+        tt->bucket_count = tt->memory ? count : 0;
+        tt->generation = 0;
+        /* align the buckets to the cache line */
+        tt->buckets = (glt__tt_bucket*)(((uintptr_t)tt->memory + 63) & ~(uintptr_t)63);
+
+        if (!tt->memory) return 0;
+
+        glt_tt_clear(tt);
+        return 1;
+}
+
+static void glt_tt_destroy(glt_tt* tt)
+{
+        if (tt->memory) GLT_free(tt->memory);
+        tt->memory = NULL;
+        tt->buckets = NULL;
+        tt->bucket_count = 0;
+}
+
+static void glt_tt_clear(glt_tt* tt)
+{
+        for (u64 i = 0; i < tt->bucket_count; ++i) {
+                for (int j = 0; j < GLT_TT_BUCKET_SIZE; ++j) {
+                        tt->buckets[i].slots[j].key = 0;
+                        tt->buckets[i].slots[j].data = 0;
+                }
+        }
+        tt->generation = 0;
+}
+
+static void glt_tt_new_search(glt_tt* tt)
+{
+        tt->generation = (tt->generation + 1) & GLT__TT_GENERATION_MASK;
+}
+
+static inline glt__tt_bucket* glt__tt_bucket_of(glt_tt* tt, u64 hash)
+{
+        return &tt->buckets[hash & (tt->bucket_count - 1)];
+}
+
+static int glt_tt_probe(glt_tt* tt, u64 hash, glt_tt_entry* entry)
+{
+        glt__tt_bucket* bucket = glt__tt_bucket_of(tt, hash);
+
+        for (int i = 0; i < GLT_TT_BUCKET_SIZE; ++i)
+        {
+                u64 key = GLT__LOAD_RELAXED(&bucket->slots[i].key);
+                u64 data = GLT__LOAD_RELAXED(&bucket->slots[i].data);
+
+                if ((key ^ data) != hash || data == 0) continue;
+
+                entry->move = (glt_move16)data;
+                entry->score = (i16)(data >> 16);
+                entry->depth = (u8)(data >> 32);
+                entry->bound = (u8)((data >> 40) & 3);
+                return 1;
+        }
+        return 0;
+}
+
+static void glt_tt_store(glt_tt* tt, u64 hash, glt_move16 move, int score, int depth, glt_bound bound)
+{
+        glt__tt_bucket* bucket = glt__tt_bucket_of(tt, hash);
+        glt__tt_slot* replace = NULL;
+        int replace_value = 0x7fffffff;
+        glt_move16 packed = move;
+
+        assert(depth >= 0 && depth <= 255);
+
+        for (int i = 0; i < GLT_TT_BUCKET_SIZE; ++i)
+        {
+                glt__tt_slot* slot = &bucket->slots[i];
+                u64 key = GLT__LOAD_RELAXED(&slot->key);
+                u64 data = GLT__LOAD_RELAXED(&slot->data);
+
+                if ((key ^ data) == hash) {
+                        /* same position, keep the old move if we don't have one */
+                        if (packed == GLT_MOVE16_NONE) packed = (glt_move16)data;
+                        replace = slot;
+                        break;
+                }
+
+                /* replace the shallowest entry, entries from old searches count as shallower */
+                int age = (tt->generation - (int)((data >> 42) & GLT__TT_GENERATION_MASK)) & GLT__TT_GENERATION_MASK;
+                int value = data == 0 ? -1000 : (int)((data >> 32) & 255) - 8 * age;
+
+                if (value < replace_value) {
+                        replace_value = value;
+                        replace = slot;
+                }
         }
 
-        board->pieces[56 + 0] = GLT_black_rook;
-        board->pieces[56 + 1] = GLT_black_knight;
-        board->pieces[56 + 2] = GLT_black_bishop;
-        board->pieces[56 + 3] = GLT_black_queen;
-        board->pieces[56 + 4] = GLT_black_king;
-        board->pieces[56 + 5] = GLT_black_bishop;
-        board->pieces[56 + 6] = GLT_black_knight;
-        board->pieces[56 + 7] = GLT_black_rook;
+        u64 data = (u64)packed
+                 | ((u64)(u16)(i16)score << 16)
+                 | ((u64)(depth & 255) << 32)
+                 | ((u64)(bound & 3) << 40)
+                 | ((u64)tt->generation << 42)
+                 | (1ull << 48);
 
-        for (int i = 0; i < 8; ++i) {
-                board->pieces[48 + i] = GLT_black_pawn;
+        GLT__STORE_RELAXED(&replace->key, hash ^ data);
+        GLT__STORE_RELAXED(&replace->data, data);
+}
+
+static int glt_tt_hashfull(glt_tt* tt)
+{
+        u64 buckets = tt->bucket_count < 250 ? tt->bucket_count : 250;
+        int used = 0;
+
+        if (buckets == 0) return 0;
+
+        for (u64 i = 0; i < buckets; ++i) {
+                for (int j = 0; j < GLT_TT_BUCKET_SIZE; ++j) {
+                        u64 data = GLT__LOAD_RELAXED(&tt->buckets[i].slots[j].data);
+                        if (data != 0 && ((data >> 42) & GLT__TT_GENERATION_MASK) == tt->generation) used++;
+                }
         }
+        return (int)(used * 1000 / (buckets * GLT_TT_BUCKET_SIZE));
+}
 
-        board->flags = 0;
-        glt__flag_set(&board->flags, glt_flag_active_color);
-        //board->fen = (char*)malloc(1000);
+static int glt_evaluate(glt_chess_board* board)
+{
+        /* promotions can take the phase over the max */
+        int phase = board->phase < GLT__PHASE_MAX ? board->phase : GLT__PHASE_MAX;
+        int score = (GLT__PSQ_MG(board->psq) * phase + GLT__PSQ_EG(board->psq) * (GLT__PHASE_MAX - phase)) / GLT__PHASE_MAX;
+
+        return glt_active_color(board) == GLT_white ? score : -score;
 }
 
-static void glt_moves_delte(glt_move** head_ptr){
-        
-        glt_move* prev = *head_ptr;
-        glt_move* curr = prev;
+/* Middlegame material of the evaluation, the king is worth more than anything it can win */
+static const int glt__see_values[13] = {0, 82, 20000, 1025, 477, 365, 337, 82, 20000, 1025, 477, 365, 337};
 
-        while(curr){
-                prev = curr->next;
-                GLT_free(curr);
-                curr = prev;
+static int glt_see(glt_chess_board* board, glt_move16 move)
+{
+        static const glt_piece order[6] = {GLT_white_pawn, GLT_white_knight, GLT_white_bishop, GLT_white_rook, GLT_white_queen, GLT_white_king};
+        const u64* pieces = board->bb_pieces;
+        u64 diagonal = pieces[GLT_white_bishop] | pieces[GLT_black_bishop] | pieces[GLT_white_queen] | pieces[GLT_black_queen];
+        u64 straight = pieces[GLT_white_rook] | pieces[GLT_black_rook] | pieces[GLT_white_queen] | pieces[GLT_black_queen];
+        int from = glt_move16_from(move), to = glt_move16_to(move);
+        glt_piece piece = board->pieces[from];
+        glt_color side = glt_piece_color(piece);
+        u64 occupied = board->bb_occupied;
+        u64 from_bb = 1ull << from;
+        u64 attackers;
+        int gain[32];
+        int depth = 0;
+
+        if (glt_move16_is_castle(move)) return 0;
+
+        GLT__TIMER_START(GLT_timer_see);
+        gain[0] = glt__see_values[board->pieces[to]];
+
+        if (glt_move16_flags(move) == GLT_move_en_passant) {
+                gain[0] = glt__see_values[GLT_white_pawn];
+                occupied ^= 1ull << (side == GLT_white ? to - 8 : to + 8);
         }
 
-        *head_ptr = NULL;
+        if (glt_move16_is_promotion(move)) {
+                piece = glt_move16_promotion(move, side);
+                gain[0] += glt__see_values[piece] - glt__see_values[GLT_white_pawn];
+        }
+
+        attackers = glt__attackers_to(board, to, occupied);
+
+        /*
+         * gain[d] is what the side that captures at d is up if its piece isn't taken back,
+         * it's filled in before knowing if the side has a piece that can capture so the last one is dropped
+         */
+        while (depth < 31)
+        {
+                depth++;
+                gain[depth] = glt__see_values[piece] - gain[depth - 1];
+
+                /* the sliders behind the piece that captured can see the square now */
+                occupied ^= from_bb;
+                attackers |= (glt_bishop_attacks(to, occupied) & diagonal) | (glt_rook_attacks(to, occupied) & straight);
+                attackers &= occupied;
+
+                /* the least valuable piece of the other side takes next */
+                side = (glt_color)(side ^ 1);
+                from_bb = 0;
+                for (int i = 0; i < 6 && !from_bb; ++i) {
+                        piece = GLT__PIECE(side, order[i]);
+                        from_bb = attackers & pieces[piece];
+                }
+                if (!from_bb) break;
+                from_bb &= 0 - from_bb;
+        }
+
+        /* from the last capture back, every side stops capturing if going on loses more */
+        while (--depth) gain[depth - 1] = -(-gain[depth - 1] > gain[depth] ? -gain[depth - 1] : gain[depth]);
+
+        GLT__TIMER_STOP(GLT_timer_see);
+        return gain[0];
 }
 
-/**
- * This is just a simple append function for the linked list
- * this is heavely used inside the chess engies for generating moves and might not
- * be required outside the library
+/* How often the search looks at the clock */
+#define GLT__SEARCH_CHECK_NODES 2048
+
+/* Everything a search thread needs */
+typedef struct {
+        glt_chess_board* board;
+        glt_tt* tt;
+        u64 nodes;
+        u64 node_limit;
+        u64 start_ms, time_limit;
+        int stopped;
+        int root_depth;
+        const u64* shared_stop; /* set by the main thread to stop the helpers, NULL on the main thread */
+
+        /* triangular principal variation table, pv[ply] is the line from ply */
+        glt_move16 pv[GLT_MAX_PLY][GLT_MAX_PLY];
+        int pv_length[GLT_MAX_PLY];
+
+        /* move ordering, the quiet moves that caused a cutoff */
+        glt_move16 killers[GLT_MAX_PLY][2];     /* the last two at the ply */
+        int history[2][4096];                   /* by the color and the from and to bits of the glt_move16 */
+} glt__search;
+
+/* The history scores are halved when one gets over this so they keep following the search */
+#define GLT__HISTORY_MAX (1 << 20)
+
+/* Mate scores are stored relative to the position in the tt, not to the root */
+static inline int glt__score_to_tt(int score, int ply)
+{
+        if (score > GLT_MATE_SCORE - GLT_MAX_PLY) return score + ply;
+        if (score < -GLT_MATE_SCORE + GLT_MAX_PLY) return score - ply;
+        return score;
+}
+
+static inline int glt__score_from_tt(int score, int ply)
+{
+        if (score > GLT_MATE_SCORE - GLT_MAX_PLY) return score - ply;
+        if (score < -GLT_MATE_SCORE + GLT_MAX_PLY) return score + ply;
+        return score;
+}
+
+static inline int glt__search_should_stop(glt__search* search)
+{
+        if (search->shared_stop) return GLT__LOAD_RELAXED(search->shared_stop) != 0;
+
+        /* depth 1 always completes so there is a move */
+        if (search->root_depth <= 1) return 0;
+        if (search->node_limit && search->nodes >= search->node_limit) return 1;
+        if (search->time_limit && (search->nodes & (GLT__SEARCH_CHECK_NODES - 1)) == 0 &&
+            GLT_time_ms() - search->start_ms >= search->time_limit) return 1;
+        return 0;
+}
+
+/*
+ * Staged move picker, hands out the moves of a node best first and only generates
+ * the next kind of moves when the ones before didn't cause a cutoff
+ *
+ *      tt move, captures by most valuable victim least valuable attacker,
+ *      killers, quiet moves by history, the captures that lose material by the static exchange
+ *
+ * The quiescence search only gets the captures that don't lose material and the queen promotions
+ */
+enum {
+        GLT__STAGE_TT,
+        GLT__STAGE_GEN_CAPTURES,
+        GLT__STAGE_CAPTURES,
+        GLT__STAGE_KILLERS,
+        GLT__STAGE_GEN_QUIETS,
+        GLT__STAGE_QUIETS,
+        GLT__STAGE_BAD_CAPTURES,
+        GLT__STAGE_DONE
+};
+
+typedef struct {
+        glt_chess_board* board;
+        int stage;
+        int index;
+        int quiescence;         /* only the captures that don't lose material and the queen promotions */
+        glt_move16 tt_move;
+        glt_move16 killers[2];
+        const int* history;     /* the history of the side to move */
+        glt_move_list list;
+        int scores[GLT_MAX_MOVES];
+        glt_move16 bad_captures[GLT_MAX_MOVES]; /* the captures that lose material, they go after the quiets */
+        int bad_count;
+} glt__move_picker;
+
+static void glt__picker_init(glt__move_picker* picker, glt_chess_board* board, glt_move16 tt_move, const glt_move16* killers, const int* history)
+{
+        picker->board = board;
+        picker->stage = GLT__STAGE_TT;
+        picker->index = 0;
+        picker->quiescence = 0;
+        picker->tt_move = tt_move;
+        picker->killers[0] = killers[0];
+        picker->killers[1] = killers[1];
+        picker->history = history;
+        picker->bad_count = 0;
+}
+
+static void glt__picker_init_quiescence(glt__move_picker* picker, glt_chess_board* board)
+{
+        picker->board = board;
+        picker->stage = GLT__STAGE_GEN_CAPTURES;
+        picker->index = 0;
+        picker->quiescence = 1;
+        picker->tt_move = GLT_MOVE16_NONE;
+        picker->killers[0] = GLT_MOVE16_NONE;
+        picker->killers[1] = GLT_MOVE16_NONE;
+        picker->history = NULL;
+        picker->bad_count = 0;
+}
+
+/* Most valuable victim first, the least valuable attacker first between the same victims */
+static void glt__score_captures(glt__move_picker* picker)
+{
+        static const int values[13] = {0, 1, 6, 5, 4, 3, 2, 1, 6, 5, 4, 3, 2};
+        glt_chess_board* board = picker->board;
+
+        for (int i = 0; i < picker->list.count; ++i)
+        {
+                glt_move16 move = picker->list.moves[i];
+
+                /* en passant captures a pawn */
+                int victim = glt_move16_flags(move) == GLT_move_en_passant ? 1 : values[board->pieces[glt_move16_to(move)]];
+                picker->scores[i] = victim * 10 - values[board->pieces[glt_move16_from(move)]];
+                if (glt_move16_is_promotion(move)) picker->scores[i] += 100 + glt_move16_flags(move);
+        }
+}
+
+/* Promotions first then by the history */
+static void glt__score_quiets(glt__move_picker* picker)
+{
+        for (int i = 0; i < picker->list.count; ++i)
+        {
+                glt_move16 move = picker->list.moves[i];
+
+                if (glt_move16_is_promotion(move)) picker->scores[i] = GLT__HISTORY_MAX * 2 + glt_move16_flags(move);
+                else picker->scores[i] = picker->history[move & 4095];
+        }
+}
+
+/* Swaps the best scored move from index on to index */
+static inline void glt__pick_move(glt_move_list* list, int* scores, int index)
+{
+        int best = index;
+
+        for (int i = index + 1; i < list->count; ++i) {
+                if (scores[i] > scores[best]) best = i;
+        }
+
+        if (best != index) {
+                glt_move16 move = list->moves[index];
+                int score = scores[index];
+                list->moves[index] = list->moves[best];
+                scores[index] = scores[best];
+                list->moves[best] = move;
+                scores[best] = score;
+        }
+}
+
+/* The next move to search, GLT_MOVE16_NONE when there are no more */
+static glt_move16 glt__picker_next(glt__move_picker* picker)
+{
+        glt_chess_board* board = picker->board;
+
+        for (;;)
+        {
+                switch (picker->stage)
+                {
+                case GLT__STAGE_TT:
+                        picker->stage = GLT__STAGE_GEN_CAPTURES;
+                        /* the tt move can be from another position with the same key */
+                        if (glt__move16_is_valid(board, picker->tt_move)) return picker->tt_move;
+                        picker->tt_move = GLT_MOVE16_NONE;
+                        break;
+
+                case GLT__STAGE_GEN_CAPTURES: {
+                        GLT__TIMER_START(GLT_timer_pick_captures);
+                        glt_move_list_clear(&picker->list);
+                        glt__generate_legal_moves(board, picker->quiescence ? GLT__GEN_CAPTURES | GLT__GEN_PROMOTIONS : GLT__GEN_CAPTURES, &picker->list);
+                        glt__score_captures(picker);
+                        GLT__TIMER_STOP(GLT_timer_pick_captures);
+                        picker->index = 0;
+                        picker->stage = GLT__STAGE_CAPTURES;
+                        break;
+                }
+
+                case GLT__STAGE_CAPTURES:
+                        while (picker->index < picker->list.count) {
+                                glt__pick_move(&picker->list, picker->scores, picker->index);
+                                glt_move16 move = picker->list.moves[picker->index++];
+
+                                if (move == picker->tt_move) continue;
+
+                                /* the quiescence search has no use for under promotions or captures that lose material */
+                                if (picker->quiescence && glt_move16_is_promotion(move) && (glt_move16_flags(move) & 3) != 3) continue;
+                                if (glt_see(board, move) < 0) {
+                                        if (!picker->quiescence) picker->bad_captures[picker->bad_count++] = move;
+                                        continue;
+                                }
+                                return move;
+                        }
+                        picker->index = 0;
+                        picker->stage = picker->quiescence ? GLT__STAGE_DONE : GLT__STAGE_KILLERS;
+                        break;
+
+                case GLT__STAGE_KILLERS:
+                        while (picker->index < 2) {
+                                glt_move16 move = picker->killers[picker->index++];
+
+                                /* a killer from a sibling can be a capture or not even be a move here */
+                                if (move != picker->tt_move && !glt_move16_is_capture(move) && glt__move16_is_valid(board, move)) return move;
+                                picker->killers[picker->index - 1] = GLT_MOVE16_NONE;
+                        }
+                        picker->stage = GLT__STAGE_GEN_QUIETS;
+                        break;
+
+                case GLT__STAGE_GEN_QUIETS: {
+                        GLT__TIMER_START(GLT_timer_pick_quiets);
+                        glt_move_list_clear(&picker->list);
+                        glt_generate_legal_quiets(board, &picker->list);
+                        glt__score_quiets(picker);
+                        GLT__TIMER_STOP(GLT_timer_pick_quiets);
+                        picker->index = 0;
+                        picker->stage = GLT__STAGE_QUIETS;
+                        break;
+                }
+
+                case GLT__STAGE_QUIETS:
+                        while (picker->index < picker->list.count) {
+                                glt__pick_move(&picker->list, picker->scores, picker->index);
+                                glt_move16 move = picker->list.moves[picker->index++];
+                                if (move != picker->tt_move && move != picker->killers[0] && move != picker->killers[1]) return move;
+                        }
+                        picker->index = 0;
+                        picker->stage = GLT__STAGE_BAD_CAPTURES;
+                        break;
+
+                case GLT__STAGE_BAD_CAPTURES:
+                        if (picker->index < picker->bad_count) return picker->bad_captures[picker->index++];
+                        picker->stage = GLT__STAGE_DONE;
+                        break;
+
+                default:
+                        return GLT_MOVE16_NONE;
+                }
+        }
+}
+
+/* A quiet move caused a cutoff, remember it for the siblings and the rest of the search */
+static void glt__update_quiet_stats(glt__search* search, glt_move16 move, int depth, int ply)
+{
+        int* history = search->history[glt_active_color(search->board)];
+
+        if (search->killers[ply][0] != move) {
+                search->killers[ply][1] = search->killers[ply][0];
+                search->killers[ply][0] = move;
+        }
+
+        history[move & 4095] += depth * depth;
+        if (history[move & 4095] > GLT__HISTORY_MAX) {
+                for (int c = 0; c < 2; ++c)
+                        for (int i = 0; i < 4096; ++i) search->history[c][i] /= 2;
+        }
+}
+
+/*
+ * Searches the captures until the position is quiet so the evaluation isn't taken in the middle of an exchange
+ * https://www.chessprogramming.org/Quiescence_Search
+ * The side to move can stand pat on the evaluation, in check all the moves are searched instead
  */
-static void glt__move_append(glt_move** head_ptr, glt_pos start, glt_pos end){
-        if (!glt_pos_in_bounds(end)) return;
+static int glt__quiescence(glt__search* search, int alpha, int beta, int ply)
+{
+        static const glt_move16 no_killers[2] = {GLT_MOVE16_NONE, GLT_MOVE16_NONE};
+        glt_chess_board* board = search->board;
+        int in_check = glt_in_check(board);
+        int best_score = -GLT_INFINITE_SCORE;
+        glt__move_picker picker;
+        glt_move16 move;
+        int legal = 0;
+
+        GLT__COUNT(GLT_counter_quiescence_nodes, 1);
+
+        if (ply >= GLT_MAX_PLY - 1) return glt_evaluate(board);
+
+        if (in_check)
+        {
+                glt__picker_init(&picker, board, GLT_MOVE16_NONE, no_killers, search->history[glt_active_color(board)]);
+        }
+        else
+        {
+                best_score = glt_evaluate(board);
+                if (best_score >= beta) return best_score;
+                if (best_score > alpha) alpha = best_score;
+
+                glt__picker_init_quiescence(&picker, board);
+        }
+
+        while ((move = glt__picker_next(&picker)) != GLT_MOVE16_NONE)
+        {
+                glt__make_move16(board, move);
+                search->nodes++;
+                legal++;
+
+                int score = -glt__quiescence(search, -beta, -alpha, ply + 1);
+                glt_unmake_move(board);
+
+                if (search->stopped || (search->stopped = glt__search_should_stop(search))) return 0;
+
+                if (score > best_score)
+                {
+                        best_score = score;
+                        if (score > alpha) {
+                                alpha = score;
+                                if (alpha >= beta) break;
+                        }
+                }
+        }
+
+        if (in_check && legal == 0) return -GLT_MATE_SCORE + ply;
+
+        return best_score;
+}
+
+static int glt__negamax(glt__search* search, int alpha, int beta, int depth, int ply)
+{
+        glt_chess_board* board = search->board;
+        int in_check = glt_in_check(board);
+        int original_alpha = alpha;
+        glt_move16 tt_move = GLT_MOVE16_NONE;
+
+        search->pv_length[ply] = ply;
+        GLT__COUNT(GLT_counter_search_nodes, 1);
+
+        if (ply > 0)
+        {
+                if (board->half_move_clock >= 100 || glt_board_repetitions(board) > 0) return 0;
+                if (ply >= GLT_MAX_PLY - 1) return glt_evaluate(board);
+        }
+
+        /* look one ply deeper when in check so we don't stop in the middle of a mate */
+        if (in_check) depth++;
+
+        if (depth <= 0)
+        {
+                GLT__TIMER_START(GLT_timer_quiescence);
+                int score = glt__quiescence(search, alpha, beta, ply);
+                GLT__TIMER_STOP(GLT_timer_quiescence);
+                return score;
+        }
+
+        if (search->tt)
+        {
+                glt_tt_entry entry;
+
+                if (glt_tt_probe(search->tt, board->hash, &entry))
+                {
+                        int score = glt__score_from_tt(entry.score, ply);
+
+                        GLT__COUNT(GLT_counter_tt_hits, 1);
+                        tt_move = entry.move;
+
+                        if (ply > 0 && entry.depth >= depth &&
+                            (entry.bound == GLT_bound_exact ||
+                             (entry.bound == GLT_bound_lower && score >= beta) ||
+                             (entry.bound == GLT_bound_upper && score <= alpha))) return score;
+                }
+        }
+
+        glt__move_picker picker;
+        int best_score = -GLT_INFINITE_SCORE;
+        glt_move16 best_move = GLT_MOVE16_NONE;
+        glt_move16 move;
+        int legal = 0;
+
+        glt__picker_init(&picker, board, tt_move, search->killers[ply], search->history[glt_active_color(board)]);
+
+        while ((move = glt__picker_next(&picker)) != GLT_MOVE16_NONE)
+        {
+                glt__make_move16(board, move);
+                search->nodes++;
+                legal++;
+
+                int score = -glt__negamax(search, -beta, -alpha, depth - 1, ply + 1);
+                glt_unmake_move(board);
+
+                if (search->stopped || (search->stopped = glt__search_should_stop(search))) return 0;
+
+                if (score > best_score)
+                {
+                        best_score = score;
+                        best_move = move;
+
+                        if (score > alpha)
+                        {
+                                alpha = score;
+
+                                /* this move followed by the line of the child */
+                                search->pv[ply][ply] = best_move;
+                                for (int j = ply + 1; j < search->pv_length[ply + 1]; ++j) search->pv[ply][j] = search->pv[ply + 1][j];
+                                search->pv_length[ply] = search->pv_length[ply + 1];
+
+                                if (alpha >= beta) {
+                                        if (!glt_move16_is_capture(move)) glt__update_quiet_stats(search, move, depth, ply);
+                                        GLT__COUNT(GLT_counter_beta_cutoffs, 1);
+                                        break;
+                                }
+                        }
+                }
+        }
+
+        if (legal == 0) return in_check ? -GLT_MATE_SCORE + ply : 0;
+
+        if (search->tt)
+        {
+                glt_bound bound = best_score >= beta ? GLT_bound_lower :
+                                  best_score > original_alpha ? GLT_bound_exact : GLT_bound_upper;
+
+                glt_tt_store(search->tt, board->hash, best_move, glt__score_to_tt(best_score, ply), depth, bound);
+        }
+
+        return best_score;
+}
+
+/* Searches the root with a window around the last score, widens it until the score is inside */
+static int glt__aspiration(glt__search* search, int depth, int last_score)
+{
+        int delta = 25;
+        int alpha = -GLT_INFINITE_SCORE, beta = GLT_INFINITE_SCORE;
+
+        if (depth >= 4) {
+                alpha = last_score - delta > -GLT_INFINITE_SCORE ? last_score - delta : -GLT_INFINITE_SCORE;
+                beta = last_score + delta < GLT_INFINITE_SCORE ? last_score + delta : GLT_INFINITE_SCORE;
+        }
+
+        for (;;)
+        {
+                int score = glt__negamax(search, alpha, beta, depth, 0);
+
+                if (search->stopped) return score;
+
+                if (score <= alpha) alpha = score - delta > -GLT_INFINITE_SCORE ? score - delta : -GLT_INFINITE_SCORE;
+                else if (score >= beta) beta = score + delta < GLT_INFINITE_SCORE ? score + delta : GLT_INFINITE_SCORE;
+                else return score;
+
+                delta *= 2;
+        }
+}
+
+/* Runs iterative deepening on the search, result gets the last completed depth */
+static void glt__iterative_deepening(glt__search* search, int start_depth, int max_depth, glt_search_result* result)
+{
+        int score = 0;
+
+        for (int depth = start_depth; depth <= max_depth; ++depth)
+        {
+                search->root_depth = depth;
+                score = glt__aspiration(search, depth, score);
+
+                if (search->stopped) break;
+
+                result->depth = depth;
+                result->score = score;
+                result->pv_length = search->pv_length[0];
+                for (int i = 0; i < result->pv_length; ++i) result->pv[i] = search->pv[0][i];
+                if (result->pv_length > 0) result->best_move = result->pv[0];
+
+                /* no need to go on after finding a mate */
+                if (score > GLT_MATE_SCORE - depth || score < -GLT_MATE_SCORE + depth) break;
+
+                if (search->node_limit && search->nodes >= search->node_limit) break;
+                if (search->time_limit && GLT_time_ms() - search->start_ms >= search->time_limit) break;
+        }
+}
+
+/* One per thread, nothing in here is shared */
+typedef struct {
+        glt__search search;
+        glt_search_result result;
+        glt_chess_board board;
+        glt_history history;
+        int start_depth, max_depth;
+#ifndef GLT_CHESS_NO_THREADS
+        glt__thread thread;
+        int started;
+#endif
+#ifdef GLT_CHESS_INSTRUMENT
+        glt_instrument_stats stats; /* of the helper thread, added to the calling thread after the join */
+#endif
+} glt__search_worker;
+
+#ifndef GLT_CHESS_NO_THREADS
+GLT__THREAD_FUNC(glt__search_helper, arg)
+{
+        glt__search_worker* worker = (glt__search_worker*)arg;
+
+        glt__iterative_deepening(&worker->search, worker->start_depth, worker->max_depth, &worker->result);
+#ifdef GLT_CHESS_INSTRUMENT
+        glt_instrument_snapshot(&worker->stats);
+#endif
+        GLT__THREAD_RETURN;
+}
+#endif
+
+static void glt_search(glt_chess_board* board, const glt_search_limits* limits, glt_search_result* result)
+{
+        int max_depth = limits->depth > 0 && limits->depth < GLT_MAX_PLY ? limits->depth : GLT_MAX_PLY - 1;
+        int threads = 1;
+        u64 stop = 0;
+
+#ifndef GLT_CHESS_NO_THREADS
+        if (limits->threads > 1) threads = limits->threads;
+#endif
+
+        result->best_move = GLT_MOVE16_NONE;
+        result->score = 0;
+        result->depth = 0;
+        result->pv_length = 0;
+        result->nodes = 0;
+
+        /* the pv tables are too big for some stacks */
+        glt__search_worker* workers = (glt__search_worker*)GLT_malloc(sizeof(glt__search_worker) * threads);
+
+        assert(workers != NULL);
+        if (!workers) return;
+
+        u64 start_ms = GLT_time_ms();
+        GLT__TIMER_START(GLT_timer_search);
+
+        if (limits->tt) glt_tt_new_search(limits->tt);
+
+        /* the search takes its moves back, a board without a history gets one for the search */
+        int borrowed = board->history == NULL;
+        if (borrowed) glt_board_set_history(board, &workers[0].history);
+
+        for (int i = 0; i < threads; ++i)
+        {
+                glt__search* search = &workers[i].search;
+
+                /* the main thread searches the callers board, the helpers a copy of it */
+                /* the helpers get the history of the game for the repetitions */
+                if (i > 0) {
+                        workers[i].board = *board;
+                        workers[i].history = *board->history;
+                        workers[i].board.history = &workers[i].history;
+                }
+                search->board = i == 0 ? board : &workers[i].board;
+                search->tt = limits->tt;
+                search->nodes = 0;
+                search->node_limit = i == 0 ? limits->nodes : 0;
+                search->time_limit = i == 0 ? limits->time_ms : 0;
+                search->start_ms = start_ms;
+                search->stopped = 0;
+                search->root_depth = 0;
+                search->shared_stop = i == 0 ? NULL : &stop;
+                memset(search->killers, 0, sizeof(search->killers));
+                memset(search->history, 0, sizeof(search->history));
+
+                workers[i].result.best_move = GLT_MOVE16_NONE;
+                workers[i].result.depth = 0;
+                workers[i].result.pv_length = 0;
+
+                /* half of the helpers start a depth ahead so the threads don't all search the same thing */
+                workers[i].start_depth = 1 + (i & 1);
+                workers[i].max_depth = max_depth;
+        }
+
+#ifndef GLT_CHESS_NO_THREADS
+        for (int i = 1; i < threads; ++i) {
+                workers[i].started = glt__thread_start(&workers[i].thread, glt__search_helper, &workers[i]);
+        }
+#endif
 
-        /* you can't insert if the head pointer is null */
-        assert(head_ptr != NULL);
+        glt__iterative_deepening(&workers[0].search, 1, max_depth, &workers[0].result);
 
+        glt_search_result* best = &workers[0].result;
+        result->nodes = workers[0].search.nodes;
 
-        /* Cast to glt_move because c++ gives you error if you don't*/
-        glt_move* new_move = (glt_move*)GLT_malloc(sizeof(glt_move));
+#ifndef GLT_CHESS_NO_THREADS
+        GLT__STORE_RELAXED(&stop, 1);
 
-        if (new_move != NULL)
+        for (int i = 1; i < threads; ++i)
         {
-                new_move->start = start;
-                new_move->end = end;
-                new_move->next = NULL;
+                if (!workers[i].started) continue;
 
-                if(*head_ptr == NULL)
-                {
-                        *head_ptr = new_move;
-                }
-                else {
-                        glt_move* curr = *head_ptr;
+                glt__thread_join(workers[i].thread);
+                result->nodes += workers[i].search.nodes;
+#ifdef GLT_CHESS_INSTRUMENT
+                glt_instrument_merge(&glt__instrument, &workers[i].stats);
+#endif
 
-                        /* go to the end*/
-                        while (curr->next != NULL) { curr = curr->next; }
+                if (workers[i].result.depth > best->depth && workers[i].result.pv_length > 0) best = &workers[i].result;
+        }
+#endif
 
-                        curr->next = new_move;
-                }
-        }else
+        if (best->depth > 0)
         {
-                //Failed to malloc
-                assert(0);
+                /* no legal moves at the root, mate or stalemate, the search still has a score */
+                if (best->pv_length > 0) result->best_move = best->best_move;
+                result->score = best->score;
+                result->depth = best->depth;
+                result->pv_length = best->pv_length;
+                for (int i = 0; i < best->pv_length; ++i) result->pv[i] = best->pv[i];
         }
 
+        result->time_ms = GLT_time_ms() - start_ms;
+        result->nps = result->nodes * 1000 / (result->time_ms ? result->time_ms : 1);
+
+        if (borrowed) board->history = NULL;
+        GLT_free(workers);
+        GLT__TIMER_STOP(GLT_timer_search);
 }
 
+static int glt_thread_count(void)
+{
+#ifndef GLT_CHESS_NO_THREADS
+        return glt__hardware_threads();
+#else
+        return 1;
+#endif
+}
 
-static glt_move* glt_generate_white_pawn_moves(glt_chess_board* board, glt_pos start)
+static int glt_perft_cache_create(glt_perft_cache* cache, size_t megabytes)
 {
-        /* Should we malloc glt_move* just to store the pointer? */
-        glt_move* head = NULL;
+        u64 bytes = (u64)megabytes << 20;
+        u64 count = 1;
 
-        glt_pos move_frd = start;
-        move_frd.y += 1;
+        while (count * 2 * sizeof(glt__perft_slot) <= bytes) count *= 2;
 
-        /* Check if it can move one step forward */
-        if (glt_piece_at_pos(board, move_frd) == GLT_none)
-        {
-                glt__move_append(&head, start, move_frd);
+        cache->slots = (glt__perft_slot*)GLT_malloc((size_t)(count * sizeof(glt__perft_slot)));
+        cache->slot_count = cache->slots ? count : 0;
 
-                /* Check if it can move two step forward (when it's in the second rank)*/
+        if (!cache->slots) return 0;
 
-                if (start.y == 2){
-                        move_frd.y += 1;
+        glt_perft_cache_clear(cache);
+        return 1;
+}
 
-                        if(glt_piece_at_pos(board, move_frd) == GLT_none)
-                        {
-                                glt__move_append(&head, start, move_frd);
-                        }
-                }
+static void glt_perft_cache_destroy(glt_perft_cache* cache)
+{
+        if (cache->slots) GLT_free(cache->slots);
+        cache->slots = NULL;
+        cache->slot_count = 0;
+}
 
+static void glt_perft_cache_clear(glt_perft_cache* cache)
+{
+        for (u64 i = 0; i < cache->slot_count; ++i) {
+                cache->slots[i].key = 0;
+                cache->slots[i].count = 0;
         }
+}
+
+/* Positions with different depths have different counts so the depth is part of the key */
+static inline u64 glt__perft_key(u64 hash, int depth)
+{
+        return hash ^ ((u64)depth * 0x9e3779b97f4a7c15ull);
+}
 
-        /* check if it can some pieces */
+/* glt_perft with a cache, like the tt the key is stored xor the count to catch torn writes */
+static u64 glt__perft_cached(glt_chess_board* board, int depth, glt_perft_cache* cache)
+{
+        if (depth <= 1) return glt__perft(board, depth);
 
-        /* Right diagonal */
-        glt_pos right_diag = start;
-        right_diag.x += 1;
-        right_diag.y += 1;
+        u64 key = glt__perft_key(board->hash, depth);
+        glt__perft_slot* slot = &cache->slots[key & (cache->slot_count - 1)];
+        u64 slot_key = GLT__LOAD_RELAXED(&slot->key);
+        u64 slot_count = GLT__LOAD_RELAXED(&slot->count);
 
-        if((glt_piece_at_pos(board, right_diag) != GLT_none) &&
-        glt_piece_is_black(glt_piece_at_pos(board, right_diag))
-        ){
-                glt__move_append(&head, start, right_diag);
-        }
+        if ((slot_key ^ slot_count) == key && slot_count != 0) return slot_count;
 
-        /* Left diagonal */
-        glt_pos left_diag = start;
-        left_diag.x -= 1;
-        left_diag.y += 1;
+        glt_move_list list;
+        u64 nodes = 0;
 
-        if((glt_piece_at_pos(board, left_diag) != GLT_none) &&
-        glt_piece_is_black(glt_piece_at_pos(board, left_diag))
-        ){
-                glt__move_append(&head, start, left_diag);
+        glt_move_list_clear(&list);
+        glt_generate_legal_moves(board, &list);
+
+        for (int i = 0; i < list.count; ++i)
+        {
+                glt__make_move16(board, list.moves[i]);
+                nodes += glt__perft_cached(board, depth - 1, cache);
+                glt_unmake_move(board);
         }
 
-        return head;
+        GLT__STORE_RELAXED(&slot->key, key ^ nodes);
+        GLT__STORE_RELAXED(&slot->count, nodes);
+        return nodes;
 }
 
-static glt_move* glt_generate_black_pawn_moves(glt_chess_board* board, glt_pos start)
+/* The moves from the root to the subtree, only the thread that runs it writes nodes */
+typedef struct {
+        glt_move16 moves[2];
+        u8 plies;
+        u64 nodes;
+} glt__perft_task;
+
+/* The range of tasks a thread owns, the owner and the thieves take tasks with the same fetch add */
+typedef struct {
+        u64 next;
+        u64 end;
+        u8 padding[48]; /* keep the counters of the threads on their own cache lines */
+} glt__perft_range;
+
+typedef struct {
+        glt_chess_board board;
+        glt_history history;
+        glt__perft_task* tasks;
+        glt__perft_range* ranges;
+        glt_perft_cache* cache;
+        int id, threads, depth;
+#ifndef GLT_CHESS_NO_THREADS
+        glt__thread thread;
+        int started;
+#endif
+#ifdef GLT_CHESS_INSTRUMENT
+        glt_instrument_stats stats;
+#endif
+} glt__perft_worker;
+
+static void glt__perft_run_task(glt__perft_worker* worker, glt__perft_task* task)
 {
-        /* Should we malloc glt_move* just to store the pointer? */
-        glt_move* head = NULL;
+        glt_chess_board* board = &worker->board;
+        int depth = worker->depth - task->plies;
 
-        glt_pos move_frd = start;
-        move_frd.y -= 1;
+        for (int i = 0; i < task->plies; ++i) glt__make_move16(board, task->moves[i]);
 
-        /* Check if it can move one step forward */
-        if (glt_piece_at_pos(board, move_frd) == GLT_none)
-        {
-                glt__move_append(&head, start, move_frd);
+        task->nodes = worker->cache ? glt__perft_cached(board, depth, worker->cache) : glt__perft(board, depth);
 
-                /* Check if it can move two step forward (when it's in the second rank)*/
+        for (int i = 0; i < task->plies; ++i) glt_unmake_move(board);
+}
 
-                if (start.y == 7){
-                        move_frd.y -= 1;
+/* Runs the own range first and then steals from the others */
+static void glt__perft_work(glt__perft_worker* worker)
+{
+        for (int i = 0; i < worker->threads; ++i)
+        {
+                glt__perft_range* range = &worker->ranges[(worker->id + i) % worker->threads];
+                u64 task;
 
-                        if(glt_piece_at_pos(board, move_frd) == GLT_none)
-                        {
-                                glt__move_append(&head, start, move_frd);
-                        }
+                while ((task = GLT__FETCH_ADD(&range->next, 1)) < range->end) {
+                        glt__perft_run_task(worker, &worker->tasks[task]);
                 }
-
         }
+}
+
+#ifndef GLT_CHESS_NO_THREADS
+GLT__THREAD_FUNC(glt__perft_thread, arg)
+{
+        glt__perft_worker* worker = (glt__perft_worker*)arg;
 
-        /* check if it can some pieces */
+        glt__perft_work(worker);
+#ifdef GLT_CHESS_INSTRUMENT
+        glt_instrument_snapshot(&worker->stats);
+#endif
+        GLT__THREAD_RETURN;
+}
+#endif
 
-        /* Right diagonal */
-        glt_pos right_diag = start;
-        right_diag.x += 1;
-        right_diag.y -= 1;
+/* Adds the legal moves of the board to tasks as the ply of the parent task, returns the new task count */
+static int glt__perft_add_tasks(glt_chess_board* board, const glt__perft_task* parent, glt__perft_task* tasks, int count)
+{
+        glt_move_list list;
+        int ply = parent ? parent->plies : 0;
 
-        if((glt_piece_at_pos(board, right_diag) != GLT_none) &&
-        glt_piece_is_white(glt_piece_at_pos(board, right_diag))
-        ){
-                glt__move_append(&head, start, right_diag);
-        }
+        glt_move_list_clear(&list);
+        glt_generate_legal_moves(board, &list);
 
-        /* Left diagonal */
-        glt_pos left_diag = start;
-        left_diag.x -= 1;
-        left_diag.y -= 1;
+        for (int i = 0; i < list.count; ++i)
+        {
+                glt__perft_task* task = &tasks[count++];
 
-        if((glt_piece_at_pos(board, left_diag) != GLT_none) &&
-        glt_piece_is_white(glt_piece_at_pos(board, left_diag))
-        ){
-                glt__move_append(&head, start, left_diag);
+                if (parent) *task = *parent;
+                task->moves[ply] = list.moves[i];
+                task->plies = (u8)(ply + 1);
+                task->nodes = 0;
         }
-        return head;
+        return count;
 }
 
+static u64 glt_perft_parallel(glt_chess_board* board, int depth, int threads, glt_perft_cache* cache)
+{
+        if (depth <= 1) return glt_perft(board, depth);
+
+#ifndef GLT_CHESS_NO_THREADS
+        if (threads <= 0) threads = glt_thread_count();
+#else
+        threads = 1;
+#endif
 
-static glt_move* glt_generate_knight_moves(glt_chess_board* board, glt_pos start){
-        glt_move* head = NULL;
-        glt_pos moves[8] = { {-2, -1}, {-2, +1}, {-1, +2}, {-1, -2}, {+2, -1}, {+2, +1}, {+1, -2}, {+1, +2} };
+        /* the root moves are the tasks at depth 2, deeper the root moves and their replies */
+        glt__perft_task roots[GLT_MAX_MOVES];
+        int root_count = glt__perft_add_tasks(board, NULL, roots, 0);
+        int count = root_count;
+        glt__perft_task* tasks = roots;
 
-        glt_piece start_piece = glt_piece_at_pos(board, start);
-        for (size_t i = 0; i < 8; i++)
+        if (depth >= 3)
         {
-                glt_pos new_move = {start.x + moves[i].x, start.y + moves[i].y};
-
-                /* if position is empty just add it*/ 
-                if (board->pieces[glt_pos_to_index(new_move)] == GLT_none) {
-                        glt__move_append(&head, start, new_move);
-                } else {
+                tasks = (glt__perft_task*)GLT_malloc(sizeof(glt__perft_task) * (size_t)(root_count > 0 ? root_count : 1) * GLT_MAX_MOVES);
+                assert(tasks != NULL);
+                if (!tasks) return 0;
 
-                        glt_piece curr_piece = glt_piece_at_pos(board, new_move);
+                glt_chess_board copy = *board;
+                glt_history history;
 
-                        /* if the pieces are different color than add it */
-                        if(!glt_pieces_is_same_color(start_piece, curr_piece))
-                        {
-                                glt__move_append(&head, start, new_move);
-                        }
+                glt_board_set_history(&copy, &history);
 
+                count = 0;
+                for (int i = 0; i < root_count; ++i)
+                {
+                        glt__make_move16(&copy, roots[i].moves[0]);
+                        count = glt__perft_add_tasks(&copy, &roots[i], tasks, count);
+                        glt_unmake_move(&copy);
                 }
         }
 
-        return head;
-}
-
-static glt_move* glt_generate_rook_moves(glt_chess_board* board, glt_pos start){
-        glt_move* head = NULL;
-        glt_piece start_piece = glt_piece_at_pos(board, start);
+        glt__perft_worker* workers = (glt__perft_worker*)GLT_malloc(sizeof(glt__perft_worker) * threads);
+        glt__perft_range* ranges = (glt__perft_range*)GLT_malloc(sizeof(glt__perft_range) * threads);
+        u64 nodes = 0;
 
-        glt_pos addr_arr[4] = {{ 0, 1}, {0, -1}, { 1, 0}, {-1, 0}};
-
-        for (size_t i = 0; i < 4; i++)
+        assert(workers != NULL && ranges != NULL);
+        if (workers && ranges)
         {
-                glt_pos adder = addr_arr[i];
-                glt_pos new_move = start;
-                new_move.y += adder.y ;
-                new_move.x += adder.x ;
-
-                while(glt_pos_in_bounds(new_move))
+                for (int i = 0; i < threads; ++i)
                 {
-                        glt_piece curr_piece = glt_piece_at_pos(board, new_move);
+                        ranges[i].next = (u64)count * i / threads;
+                        ranges[i].end = (u64)count * (i + 1) / threads;
+
+                        workers[i].board = *board;
+                        glt_board_set_history(&workers[i].board, &workers[i].history);
+                        workers[i].tasks = tasks;
+                        workers[i].ranges = ranges;
+                        workers[i].cache = cache && cache->slot_count ? cache : NULL;
+                        workers[i].id = i;
+                        workers[i].threads = threads;
+                        workers[i].depth = depth;
+                }
+
+#ifndef GLT_CHESS_NO_THREADS
+                for (int i = 1; i < threads; ++i) {
+                        workers[i].started = glt__thread_start(&workers[i].thread, glt__perft_thread, &workers[i]);
+                }
+#endif
 
-                        if (curr_piece == GLT_none)  glt__move_append(&head, start, new_move);
+                /* the calling thread is worker 0, it steals whatever the threads that didn't start leave */
+                glt__perft_work(&workers[0]);
 
-                         else if(glt_pieces_is_same_color(start_piece, curr_piece)) break;
+#ifndef GLT_CHESS_NO_THREADS
+                for (int i = 1; i < threads; ++i) {
+                        if (!workers[i].started) continue;
 
-                        else{
-                                glt__move_append(&head, start, new_move);
-                                break;
-                        }
-                        new_move.y += adder.y;
-                        new_move.x += adder.x;
+                        glt__thread_join(workers[i].thread);
+#ifdef GLT_CHESS_INSTRUMENT
+                        glt_instrument_merge(&glt__instrument, &workers[i].stats);
+#endif
                 }
+#endif
+
+                for (int i = 0; i < count; ++i) nodes += tasks[i].nodes;
         }
-        return head;
-        
 
+        if (workers) GLT_free(workers);
+        if (ranges) GLT_free(ranges);
+        if (tasks != roots) GLT_free(tasks);
+        return nodes;
 }
 
-static glt_move* glt_generate_bishop_moves(glt_chess_board* board, glt_pos start)
+static inline glt_view glt__view(const char* start, const char* end)
 {
-        glt_move * head = NULL;
+        glt_view view;
+        view.data = start;
+        view.length = (size_t)(end - start);
+        return view;
+}
 
-        glt_piece start_piece = glt_piece_at_pos(board, start);
+static inline int glt__pgn_is_space(char c)
+{
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
 
-        glt_pos addr_arr[4] = {{ 1, 1}, {1, -1}, { -1, 1}, {-1, -1}};
+static inline const char* glt__pgn_skip_space(const char* p, const char* end)
+{
+        while (p < end && glt__pgn_is_space(*p)) p++;
+        return p;
+}
 
-        for (size_t i = 0; i < 4; i++)
-        {
-                glt_pos adder = addr_arr[i];
-                glt_pos new_move = start;
-                new_move.y += adder.y ;
-                new_move.x += adder.x ;
+/* Moves to the start of the next line */
+static inline const char* glt__pgn_next_line(const char* p, const char* end)
+{
+        const char* line = (const char*)memchr(p, '\n', (size_t)(end - p));
+        return line ? line + 1 : end;
+}
 
-                while(glt_pos_in_bounds(new_move))
-                {
-                        glt_piece curr_piece = glt_piece_at_pos(board, new_move);
+static void glt_pgn_reader_init(glt_pgn_reader* reader, const char* data, size_t size)
+{
+        reader->cursor = data;
+        reader->end = data + size;
+}
 
-                        if (curr_piece == GLT_none)  glt__move_append(&head, start, new_move);
+static int glt_pgn_next_game(glt_pgn_reader* reader, glt_pgn_game* game)
+{
+        const char* end = reader->end;
+        const char* p = glt__pgn_skip_space(reader->cursor, end);
+        const char* tags_end;
+
+        if (p >= end) {
+                reader->cursor = end;
+                return 0;
+        }
 
-                         else if(glt_pieces_is_same_color(start_piece, curr_piece)) break;
+        game->text.data = p;
 
-                        else{
-                                glt__move_append(&head, start, new_move);
-                                break;
-                        }
-                        new_move.y += adder.y;
-                        new_move.x += adder.x;
+        /* the tags are the lines that start with [ */
+        tags_end = p;
+        while (p < end && *p == '[') {
+                p = glt__pgn_next_line(p, end);
+                tags_end = p;
+                p = glt__pgn_skip_space(p, end);
+        }
+        game->tags = glt__view(game->text.data, tags_end);
+
+        /* the movetext goes on until a line starts with [ outside of a comment */
+        const char* movetext = p;
+        while (p < end)
+        {
+                char c = *p;
+
+                if (c == '{') {
+                        const char* close = (const char*)memchr(p, '}', (size_t)(end - p));
+                        p = close ? close + 1 : end;
+                } else if (c == ';') {
+                        /* stop on the newline so a tag on the next line ends the game, the text may end without one */
+                        const char* next = glt__pgn_next_line(p, end);
+                        p = next == end ? end : next - 1;
+                } else if (c == '\n' && p + 1 < end && p[1] == '[') {
+                        break;
+                } else {
+                        p++;
                 }
         }
-        return head;
+
+        const char* movetext_end = p;
+        while (movetext_end > movetext && glt__pgn_is_space(movetext_end[-1])) movetext_end--;
+
+        game->movetext = glt__view(movetext, movetext_end);
+        game->text.length = (size_t)(movetext_end - game->text.data);
+        reader->cursor = p;
+        return 1;
 }
 
-static glt_move* glt_generate_king_moves(glt_chess_board* board, glt_pos start){
+static int glt_pgn_next_tag(glt_view* cursor, glt_pgn_tag* tag)
+{
+        const char* p = cursor->data;
+        const char* end = p + cursor->length;
+
+        p = glt__pgn_skip_space(p, end);
+        if (p >= end || *p != '[') return 0;
 
-        glt_move * head = NULL;
-        glt_piece start_piece = glt_piece_at_pos(board, start);
+        p = glt__pgn_skip_space(p + 1, end);
+        const char* name = p;
+        while (p < end && !glt__pgn_is_space(*p) && *p != '"' && *p != ']') p++;
+        tag->name = glt__view(name, p);
+
+        p = glt__pgn_skip_space(p, end);
+        if (p < end && *p == '"')
+        {
+                const char* value = ++p;
+                while (p < end && *p != '"') p += *p == '\\' && p + 1 < end ? 2 : 1;
+                tag->value = glt__view(value, p < end ? p : end);
+        }
+        else tag->value = glt__view(p, p);
 
-        glt_pos addr_arr[] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1},  // diag
-                              {0, 1}, {0, -1}, {1, 0},  {-1, 0}};  // staright
+        p = glt__pgn_next_line(p, end);
+        cursor->data = p;
+        cursor->length = (size_t)(end - p);
+        return 1;
+}
 
+static int glt_pgn_find_tag(const glt_pgn_game* game, const char* name, glt_view* value)
+{
+        glt_view cursor = game->tags;
+        glt_pgn_tag tag;
+        size_t length = strlen(name);
 
-        for (size_t i = 0; i < 8; i++)
+        while (glt_pgn_next_tag(&cursor, &tag))
         {
-                glt_pos adder = addr_arr[i];
-                glt_pos new_move = start;
-                new_move.y += adder.y ;
-                new_move.x += adder.x ;
+                if (tag.name.length == length && memcmp(tag.name.data, name, length) == 0) {
+                        *value = tag.value;
+                        return 1;
+                }
+        }
+        return 0;
+}
 
-                if(glt_pos_in_bounds(new_move))
-                {
-                        glt_piece curr_piece = glt_piece_at_pos(board, new_move);
+static int glt_pgn_next_san(glt_view* cursor, glt_view* san)
+{
+        const char* p = cursor->data;
+        const char* end = p + cursor->length;
+        int found = 0;
 
-                        if (curr_piece == GLT_none)  {
-                                glt__move_append(&head, start, new_move);
-                        } else if(!glt_pieces_is_same_color(start_piece, curr_piece)) { 
-                                glt__move_append(&head, start, new_move); 
+        while (p < end && !found)
+        {
+                char c = *p;
+
+                if (glt__pgn_is_space(c) || c == '.') {
+                        p++;
+                } else if (c == '{') {
+                        const char* close = (const char*)memchr(p, '}', (size_t)(end - p));
+                        p = close ? close + 1 : end;
+                } else if (c == ';') {
+                        p = glt__pgn_next_line(p, end);
+                } else if (c == '(') {
+                        /* variations can be nested and have comments */
+                        int depth = 0;
+                        for (; p < end; ++p) {
+                                if (*p == '(') depth++;
+                                else if (*p == ')' && --depth == 0) break;
+                                else if (*p == '{') {
+                                        const char* close = (const char*)memchr(p, '}', (size_t)(end - p));
+                                        if (!close) break;
+                                        p = close;
+                                }
+                        }
+                        if (p < end) p++;
+                } else if (c == '$') {
+                        p++;
+                        while (p < end && *p >= '0' && *p <= '9') p++;
+                } else if (c == '*') {
+                        p = end;
+                } else if (c >= '1' && c <= '9') {
+                        /* move number or result, 0-0 is castling so 0 isn't here */
+                        const char* number = p;
+                        while (p < end && *p >= '0' && *p <= '9') p++;
+                        if (p < end && (*p == '-' || *p == '/') && p - number == 1) p = end;
+                } else {
+                        const char* start = p;
+                        while (p < end && !glt__pgn_is_space(*p) && *p != '{' && *p != '(' && *p != ')' && *p != ';' && *p != '$') p++;
+
+                        /* 0-1 starts with a 0 */
+                        if (p - start == 3 && start[0] == '0' && start[1] == '-' && start[2] == '1') {
+                                p = end;
+                        } else {
+                                *san = glt__view(start, p);
+                                found = 1;
                         }
                 }
         }
-        return head;
+
+        cursor->data = p;
+        cursor->length = (size_t)(end - p);
+        return found;
 }
 
-static glt_move* glt_generate_queen_moves(glt_chess_board* board, glt_pos start) 
+static int glt_pgn_play(const glt_pgn_game* game, glt_chess_board* board, glt_pgn_move_fn callback, void* user)
 {
-        glt_move* head = NULL;
-        glt_piece start_piece = glt_piece_at_pos(board, start);
+        glt_view cursor = game->movetext;
+        glt_view san, fen;
+        int count = 0;
+
+        if (glt_pgn_find_tag(game, "FEN", &fen))
+        {
+                char buffer[GLT_MAX_FEN_LENGTH];
 
-        glt_pos addr_arr[] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1},  // diag
-                              {0, 1}, {0, -1}, {1, 0},  {-1, 0}};  // staright
+                if (fen.length >= sizeof(buffer)) return -1;
+                memcpy(buffer, fen.data, fen.length);
+                buffer[fen.length] = '\0';
+                if (glt_set_board_from_fen(board, buffer) != GLT_fen_ok) return -1;
+        }
+        else
+        {
+                glt_initilize_board(board);
+        }
 
-        for (size_t i = 0; i < 8; i++)
+        while (glt_pgn_next_san(&cursor, &san))
         {
-                glt_pos adder = addr_arr[i];
-                glt_pos new_move = start;
-                new_move.y += adder.y ;
-                new_move.x += adder.x ;
+                glt_move16 move = glt_move16_from_san(board, san.data, san.length);
 
-                while(glt_pos_in_bounds(new_move))
-                {
-                        glt_piece curr_piece = glt_piece_at_pos(board, new_move);
+                if (move == GLT_MOVE16_NONE) return -1;
+                if (callback && !callback(board, move, user)) break;
+
+                glt__make_move16(board, move);
+                count++;
+        }
+        return count;
+}
 
-                        if (curr_piece == GLT_none)  glt__move_append(&head, start, new_move);
+static void glt_pgn_split(const char* data, size_t size, int parts, size_t* offsets)
+{
+        const char* end = data + size;
 
-                         else if(glt_pieces_is_same_color(start_piece, curr_piece)) break;
+        offsets[0] = 0;
+        offsets[parts] = size;
 
-                        else{
-                                glt__move_append(&head, start, new_move);
-                                break;
-                        }
-                        new_move.y += adder.y;
-                        new_move.x += adder.x;
+        for (int i = 1; i < parts; ++i)
+        {
+                size_t start = size / parts * i;
+                const char* p = data + (start > offsets[i - 1] ? start : offsets[i - 1]);
+
+                /* a game starts at a tag line that comes after a line that isn't a tag */
+                int after_tag = 1;
+                while (p < end)
+                {
+                        p = glt__pgn_next_line(p, end);
+                        if (p >= end) break;
+                        if (*p == '[' && !after_tag) break;
+                        after_tag = *p == '[';
                 }
+                offsets[i] = (size_t)(p - data);
         }
-        return head;
 }
 
+#ifndef GLT_CHESS_NO_STDIO
+#if defined(_WIN32)
+#include <windows.h>
 
-static glt_move* glt_generate_moves(glt_chess_board * board, glt_pos pos) {
-        glt_piece piece = glt_piece_at_pos(board, pos);
-        glt_move * ret = NULL;
-        switch (piece) {
-                case GLT_black_knight:
-                case GLT_white_knight:
-                        ret = glt_generate_knight_moves(board, pos);
-                        return ret;
-                case GLT_black_pawn:
-                        ret = glt_generate_black_pawn_moves(board, pos);
-                        return ret;
-                case GLT_white_pawn:
-                        ret = glt_generate_white_pawn_moves(board, pos);
-                        return ret;
-                case GLT_white_bishop:
-                case GLT_black_bishop:
-                        ret = glt_generate_bishop_moves(board, pos);
-                        return ret;
-                case GLT_white_rook:
-                case GLT_black_rook:
-                        ret = glt_generate_rook_moves(board, pos);
-                        return ret;
-                case GLT_black_queen:
-                case GLT_white_queen:
-                        ret = glt_generate_queen_moves(board, pos);
-                        return ret;
-                case GLT_black_king:
-                case GLT_white_king:
-                        ret = glt_generate_king_moves(board, pos);
-                        return ret;
-                default:
-                        ret = NULL;
+static int glt_pgn_open(glt_pgn_file* file, const char* path)
+{
+        HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        LARGE_INTEGER size;
+
+        file->data = NULL;
+        file->size = 0;
+        file->handle = NULL;
+
+        if (handle == INVALID_HANDLE_VALUE) return 0;
+        if (!GetFileSizeEx(handle, &size)) {
+                CloseHandle(handle);
+                return 0;
         }
-        return ret;
-}
 
+        file->size = (size_t)size.QuadPart;
+        if (file->size == 0) {
+                CloseHandle(handle);
+                file->data = "";
+                return 1;
+        }
 
-static int glt_make_move(glt_chess_board* board, glt_move move){
+        HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+        CloseHandle(handle);
+        if (!mapping) return 0;
 
-        glt_piece piece = glt_piece_at_pos(board, move.start);
+        file->data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        file->handle = mapping;
+        if (!file->data) {
+                CloseHandle(mapping);
+                file->handle = NULL;
+                return 0;
+        }
+        return 1;
+}
 
-        assert(glt_pos_in_bounds(move.start));
-        assert(glt_pos_in_bounds(move.end));
+static void glt_pgn_close(glt_pgn_file* file)
+{
+        if (file->handle) {
+                UnmapViewOfFile(file->data);
+                CloseHandle((HANDLE)file->handle);
+        }
+        file->data = NULL;
+        file->size = 0;
+        file->handle = NULL;
+}
+#elif (defined(__unix__) || defined(__APPLE__)) && !defined(GLT_CHESS_NO_MMAP)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
-        if(!glt_piece_is_active_color(board, piece)) return 0;
+static int glt_pgn_open(glt_pgn_file* file, const char* path)
+{
+        struct stat st;
+        int fd = open(path, O_RDONLY);
 
-        /**  TODO: add to audit */
+        file->data = NULL;
+        file->size = 0;
+        file->handle = NULL;
 
-        board->pieces[glt_pos_to_index(move.start)] = GLT_none;
-        board->pieces[glt_pos_to_index(move.end)]   = piece;
+        if (fd < 0) return 0;
+        if (fstat(fd, &st) != 0) {
+                close(fd);
+                return 0;
+        }
 
-        glt__flip_flag(&board->flags, glt_flag_active_color);
+        file->size = (size_t)st.st_size;
+        if (file->size == 0) {
+                close(fd);
+                file->data = "";
+                return 1;
+        }
 
-        return 1;
+        void* data = mmap(NULL, file->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED) return 0;
 
+#ifdef MADV_SEQUENTIAL
+        madvise(data, file->size, MADV_SEQUENTIAL);
+#endif
+        file->data = (const char*)data;
+        file->handle = data;
+        return 1;
 }
 
-static char glt_get_fen_char(glt_piece piece ) {
-  switch (piece) {
-    case GLT_white_pawn:
-      return 'P';
-    case GLT_white_king:
-      return 'K';
-    case GLT_white_queen:
-      return 'Q';
-    case GLT_white_rook:
-      return 'R';
-    case GLT_white_bishop:
-      return 'B';
-    case GLT_white_knight:
-      return 'N';
-    case GLT_black_pawn:
-      return 'p';
-    case GLT_black_king:
-      return 'k';
-    case GLT_black_queen:
-      return 'q';
-    case GLT_black_rook:
-      return 'r';
-    case GLT_black_bishop:
-      return 'b';
-    case GLT_black_knight:
-      return 'n';
-    case GLT_none:
-      return '-';  // Placeholder for empty square
-    default:
-      return '-';
-  }
+static void glt_pgn_close(glt_pgn_file* file)
+{
+        if (file->handle) munmap(file->handle, file->size);
+        file->data = NULL;
+        file->size = 0;
+        file->handle = NULL;
 }
-
-static void glt_get_fen_from_board(glt_chess_board *board, char* fen, int len)
+#else
+/* No mmap, read the whole file */
+static int glt_pgn_open(glt_pgn_file* file, const char* path)
 {
-        /* Assert that len is greater than 100  */
-        assert(len >= 100);
-        memset(fen, 0x00, 100);
+        FILE* f = fopen(path, "rb");
+        long size;
 
-        u8 empty_count = 0;
-        u8 index = 0;
-
-        /* go thru all the squares */
-        for (int rank = 1; rank <= 8; rank++)
-        {
-                for (int file = 1; file <= 8; file++)
-                {
-                        glt_pos pos;
-                        pos.x = file;
-                        pos.y = rank;
-                        glt_piece piece = board->pieces[glt_pos_to_index(pos)];
-
-                        if(piece == GLT_none){
-                                empty_count += 1; 
-                        }else{
-                                if (empty_count > 0){
-                                        fen[index++] = '0' + empty_count; //Convert int to char
-                                        empty_count  = 0;
-                                }
-                        }
-                        fen[index++] = glt_get_fen_char(piece);
-                }
+        file->data = NULL;
+        file->size = 0;
+        file->handle = NULL;
 
-                if(empty_count > 0)
-                {
-                        fen[index++] = '0' + empty_count;
-                        empty_count  = 0;
-                }
+        if (!f) return 0;
+        if (fseek(f, 0, SEEK_END) != 0 || (size = ftell(f)) < 0 || fseek(f, 0, SEEK_SET) != 0) {
+                fclose(f);
+                return 0;
+        }
 
-                //add a '/' after 
-                if(rank < 7)  fen[index++] = '/'; 
+        char* data = (char*)GLT_malloc((size_t)size + 1);
+        if (!data || fread(data, 1, (size_t)size, f) != (size_t)size) {
+                if (data) GLT_free(data);
+                fclose(f);
+                return 0;
         }
-        fen[index++] = ' ';
+        fclose(f);
 
-        //active color
+        data[size] = '\0';
+        file->data = data;
+        file->size = (size_t)size;
+        file->handle = data;
+        return 1;
+}
 
-        if(glt__is_flag_set(board->flags, glt_flag_active_color)) fen[index++] = 'w';
-        else fen[index++] = 'b';
+static void glt_pgn_close(glt_pgn_file* file)
+{
+        if (file->handle) GLT_free(file->handle);
+        file->data = NULL;
+        file->size = 0;
+        file->handle = NULL;
+}
+#endif
+#endif
 
+static void glt_instrument_snapshot(glt_instrument_stats* stats)
+{
+#ifdef GLT_CHESS_INSTRUMENT
+        *stats = glt__instrument;
+#else
+        memset(stats, 0, sizeof(*stats));
+#endif
+}
 
-        if (glt__is_flag_set(board->flags, glt_white_king_castle))  fen[index++] = 'K';
-        if (glt__is_flag_set(board->flags, glt_white_queen_castle)) fen[index++] = 'Q';
-        if (glt__is_flag_set(board->flags, glt_black_king_castle))  fen[index++] = 'k';
-        if (glt__is_flag_set(board->flags, glt_black_queen_castle)) fen[index++] = 'q';
+static void glt_instrument_reset(void)
+{
+#ifdef GLT_CHESS_INSTRUMENT
+        memset(&glt__instrument, 0, sizeof(glt__instrument));
+#endif
+}
 
+static void glt_instrument_merge(glt_instrument_stats* into, const glt_instrument_stats* from)
+{
+        for (int i = 0; i < GLT_counter_count; ++i) into->counters[i] += from->counters[i];
 
-        /** if none of the flag is set */
-        if (!glt__is_flag_set(board->flags, 
-                glt_white_queen_castle |
-                glt_white_king_castle  | 
-                glt_black_king_castle  | 
-                glt_black_queen_castle
-                ))
-        {
-                fen[index++] = '-';
+        for (int i = 0; i < GLT_timer_count; ++i) {
+                into->calls[i] += from->calls[i];
+                into->cycles[i] += from->cycles[i];
         }
+}
 
+static const char* glt_counter_name(glt_counter counter)
+{
+        static const char* names[GLT_counter_count] = {
+                "moves_generated", "node_allocs", "node_mallocs", "illegal_moves",
+                "search_nodes", "quiescence_nodes", "tt_hits", "beta_cutoffs",
+        };
+        return (unsigned)counter < GLT_counter_count ? names[counter] : "";
+}
 
-        fen[index++] = ' ';
+static const char* glt_timer_name(glt_timer timer)
+{
+        static const char* names[GLT_timer_count] = {
+                "generate_pawn", "generate_knight", "generate_bishop", "generate_rook", "generate_queen",
+                "generate_king", "generate_position", "generate_legal", "make_move", "unmake_move",
+                "fen_parse", "fen_write", "search", "quiescence", "pick_captures", "pick_quiets", "see",
+        };
+        return (unsigned)timer < GLT_timer_count ? names[timer] : "";
+}
 
-        /* en pasant */
-        fen[index++] = '-';
+#ifndef GLT_CHESS_NO_STDIO
+static void glt_instrument_write(const glt_instrument_stats* stats, FILE* file, int json)
+{
+        if (json)
+        {
+                fputs("{\"counters\":{", file);
+                for (int i = 0; i < GLT_counter_count; ++i) {
+                        fprintf(file, "%s\"%s\":%llu", i ? "," : "", glt_counter_name((glt_counter)i),
+                                (unsigned long long)stats->counters[i]);
+                }
 
-        /* change to something with clib independent */
-        index += sprintf(&fen[index], " %d", board->half_move_clock);
-        index += sprintf(&fen[index], " %d", board->full_move_clock);
+                fputs("},\"timers\":{", file);
+                for (int i = 0; i < GLT_timer_count; ++i) {
+                        fprintf(file, "%s\"%s\":{\"calls\":%llu,\"cycles\":%llu}", i ? "," : "", glt_timer_name((glt_timer)i),
+                                (unsigned long long)stats->calls[i], (unsigned long long)stats->cycles[i]);
+                }
+                fputs("}}\n", file);
+                return;
+        }
 
-        fen[index] = '\0';
+        for (int i = 0; i < GLT_counter_count; ++i) {
+                fprintf(file, "%-18s %14llu\n", glt_counter_name((glt_counter)i), (unsigned long long)stats->counters[i]);
+        }
 
+        fprintf(file, "\n%-18s %14s %16s %12s\n", "timer", "calls", "cycles", "per call");
+        for (int i = 0; i < GLT_timer_count; ++i) {
+                u64 calls = stats->calls[i];
 
+                fprintf(file, "%-18s %14llu %16llu %12.1f\n", glt_timer_name((glt_timer)i), (unsigned long long)calls,
+                        (unsigned long long)stats->cycles[i], calls ? (double)stats->cycles[i] / (double)calls : 0.0);
+        }
 }
+#endif
 
 //DEMO application
 #if 0
@@ -0,0 +1,163 @@
+/**
+        Packed position format and packed file test for glt_chess.h
+
+        cc -O2 -o glt_chess_packed tests/glt_chess_packed.c
+        ./glt_chess_packed [file]      file is the scratch file, glt_chess_packed.bin by default
+
+        Returns non zero if any of the checks fails
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+/* small blocks so the files have several of them */
+#define GLT_PACKED_BLOCK_POSITIONS 4
+#define GLT_CHESS_IMPLEMENTATION
+#include "../glt_chess.h"
+
+static const char* fens[] = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "rnbqkbnr/pppp1ppp/8/8/3Pp3/8/PPP1PPPP/RNBQKBNR b KQkq d3 0 3",
+        "rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 3",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "4k3/8/8/8/8/8/8/4K2R w K - 99 300",
+        "8/8/8/8/8/8/8/K6k b - - 12 65535",
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w - - 0 1",
+        "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+};
+
+#define FEN_COUNT (int)(sizeof(fens) / sizeof(fens[0]))
+
+static int failed = 0;
+
+static void check(int ok, const char* what)
+{
+        printf("%-48s %s\n", what, ok ? "ok" : "FAIL");
+        if (!ok) failed++;
+}
+
+/* Writes every fen to the file, returns 0 if any step failed */
+static int write_file(const char* path)
+{
+        glt_packed_writer writer;
+        glt_chess_board board;
+        int ok = 1;
+
+        remove(path);
+        if (!glt_packed_writer_open(&writer, path)) return 0;
+
+        for (int i = 0; i < FEN_COUNT; ++i) {
+                glt_set_board_from_fen(&board, fens[i]);
+                ok &= glt_packed_write(&writer, &board);
+        }
+        return glt_packed_writer_close(&writer) && ok;
+}
+
+/* Reads the file back, returns the number of positions that match the fens, -1 if the reader reports a error */
+static int read_file(const char* path)
+{
+        glt_packed_reader reader;
+        glt_chess_board board;
+        char fen[GLT_MAX_FEN_LENGTH];
+        int count = 0;
+
+        if (!glt_packed_reader_open(&reader, path)) return -1;
+
+        while (glt_packed_read(&reader, &board)) {
+                glt_get_fen_from_board(&board, fen, sizeof(fen));
+                if (count < FEN_COUNT && strcmp(fen, fens[count]) == 0) count++;
+        }
+
+        int error = reader.error;
+        glt_packed_reader_close(&reader);
+        return error ? -1 : count;
+}
+
+/* Xors the byte at offset of the file with mask */
+static int damage_file(const char* path, long offset, u8 mask)
+{
+        FILE* file = fopen(path, "r+b");
+        int c;
+
+        if (!file) return 0;
+        if (fseek(file, offset, SEEK_SET) != 0 || (c = fgetc(file)) == EOF) {
+                fclose(file);
+                return 0;
+        }
+        fseek(file, offset, SEEK_SET);
+        fputc(c ^ mask, file);
+        fclose(file);
+        return 1;
+}
+
+int main(int argc, char const *argv[])
+{
+        const char* path = argc >= 2 ? argv[1] : "glt_chess_packed.bin";
+        long block_size = 16 + GLT_PACKED_BLOCK_POSITIONS * (long)sizeof(glt_packed_position);
+        int round_trips = 0;
+
+        check(sizeof(glt_packed_position) == 32, "packed position is 32 bytes");
+
+        for (int i = 0; i < FEN_COUNT; ++i)
+        {
+                glt_chess_board board, unpacked;
+                glt_packed_position packed;
+                char fen[GLT_MAX_FEN_LENGTH];
+
+                glt_set_board_from_fen(&board, fens[i]);
+                glt_pack_position(&board, &packed);
+
+                if (!glt_unpack_position(&packed, &unpacked)) continue;
+                glt_get_fen_from_board(&unpacked, fen, sizeof(fen));
+
+                if (strcmp(fen, fens[i]) == 0 && unpacked.hash == board.hash && unpacked.checkers == board.checkers) round_trips++;
+                else printf("%s\n  came back as %s\n", fens[i], fen);
+        }
+        check(round_trips == FEN_COUNT, "pack and unpack give the fen back");
+
+        glt_packed_position junk;
+        glt_chess_board board;
+        memset(&junk, 0xff, sizeof(junk));
+        check(!glt_unpack_position(&junk, &board), "unpack turns down junk");
+
+        /* d6 is fine with white to move and the black pawn on d5, nothing else is */
+        {
+                static const u8 bad_squares[] = { 19, 27, 35, 44, 47, 16 };
+                glt_packed_position packed;
+                int rejected = 0;
+
+                glt_set_board_from_fen(&board, fens[2]);
+                glt_pack_position(&board, &packed);
+                for (size_t i = 0; i < sizeof(bad_squares); ++i) {
+                        packed.en_passant = bad_squares[i];
+                        rejected += !glt_unpack_position(&packed, &board);
+                }
+                packed.en_passant = 43;
+                packed.state |= 16;
+                rejected += !glt_unpack_position(&packed, &board);
+                packed.state &= 15;
+                check(glt_unpack_position(&packed, &board) && rejected == (int)sizeof(bad_squares) + 1, "unpack turns down bad en passant squares");
+        }
+
+        check(write_file(path), "write the file");
+        check(read_file(path) == FEN_COUNT, "read the file back");
+
+        /* a position of the second block */
+        check(damage_file(path, block_size + 16 + 5, 0x10), "damage a position");
+        check(read_file(path) == -1, "damaged position is reported");
+
+        write_file(path);
+        check(damage_file(path, block_size + 12, 0x01), "damage a checksum");
+        check(read_file(path) == -1, "damaged checksum is reported");
+
+        write_file(path);
+        check(damage_file(path, block_size, 0x20), "damage a block header");
+        check(read_file(path) == -1, "damaged header is reported");
+
+        remove(path);
+
+        printf("%s\n", failed ? "FAILED" : "all checks pass");
+        return failed != 0;
+}
@@ -0,0 +1,139 @@
+/**
+        Perft benchmark and move generator regression test for glt_chess.h
+
+        cc -O2 -pthread -o glt_chess_perft tests/glt_chess_perft.c
+
+        ./glt_chess_perft                        runs the suite up to depth 4
+        ./glt_chess_perft suite <depth>          runs the suite up to depth
+        ./glt_chess_perft parallel <depth> [n]   runs the suite with glt_perft_parallel on n threads, all by default
+        ./glt_chess_perft divide <depth> [fen]   prints the node count of every root move
+
+        Returns non zero if any of the counts doesn't match
+        The expected counts are from https://www.chessprogramming.org/Perft_Results
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define GLT_CHESS_IMPLEMENTATION
+#include "../glt_chess.h"
+
+#define START_FEN "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
+
+typedef struct {
+        const char* name;
+        const char* fen;
+        u64 counts[6]; /* expected count at depth 1 to 6, 0 if unknown */
+} perft_position;
+
+static const perft_position suite[] = {
+        { "startpos", START_FEN,
+          { 20, 400, 8902, 197281, 4865609, 119060324 } },
+        { "kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+          { 48, 2039, 97862, 4085603, 193690690, 0 } },
+        { "position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+          { 14, 191, 2812, 43238, 674624, 11030083 } },
+        { "position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+          { 6, 264, 9467, 422333, 15833292, 706045033 } },
+        { "position 4 mirrored", "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1",
+          { 6, 264, 9467, 422333, 15833292, 706045033 } },
+        { "position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+          { 44, 1486, 62379, 2103487, 89941194, 0 } },
+        { "position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+          { 46, 2079, 89890, 3894594, 164075551, 0 } },
+};
+
+static double seconds(void)
+{
+        struct timespec ts;
+        timespec_get(&ts, TIME_UTC);
+        return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* threads 0 runs glt_perft, otherwise glt_perft_parallel */
+static int run_suite(int max_depth, int threads)
+{
+        int failed = 0;
+        u64 total_nodes = 0;
+        double total_time = 0;
+
+        for (size_t i = 0; i < sizeof(suite) / sizeof(suite[0]); ++i)
+        {
+                glt_chess_board board;
+                glt_set_board_from_fen(&board, suite[i].fen);
+
+                for (int depth = 1; depth <= max_depth && depth <= 6; ++depth)
+                {
+                        u64 expected = suite[i].counts[depth - 1];
+                        if (expected == 0) break;
+
+                        double start = seconds();
+                        u64 nodes = threads ? glt_perft_parallel(&board, depth, threads, NULL) : glt_perft(&board, depth);
+                        double time = seconds() - start;
+
+                        total_nodes += nodes;
+                        total_time += time;
+
+                        printf("%-20s depth %d %12llu %s %10.0f nps\n", suite[i].name, depth,
+                                (unsigned long long)nodes, nodes == expected ? "ok  " : "FAIL",
+                                time > 0 ? (double)nodes / time : 0.0);
+
+                        if (nodes != expected) {
+                                printf("%-20s expected %llu\n", "", (unsigned long long)expected);
+                                failed++;
+                        }
+                }
+        }
+
+        printf("\n%llu nodes in %.3fs, %.0f nps\n", (unsigned long long)total_nodes, total_time,
+                total_time > 0 ? (double)total_nodes / total_time : 0.0);
+        printf("%s\n", failed ? "FAILED" : "all counts match");
+
+        return failed;
+}
+
+static void run_divide(int depth, const char* fen)
+{
+        glt_chess_board board;
+        glt_move_list moves;
+        u64 counts[GLT_MAX_MOVES];
+        char str[6];
+
+        glt_fen_error error = glt_set_board_from_fen(&board, fen);
+        if (error != GLT_fen_ok) {
+                printf("invalid fen: %s (%s)\n", fen, glt_fen_error_string(error));
+                return;
+        }
+
+        double start = seconds();
+        u64 nodes = glt_perft_divide(&board, depth, &moves, counts);
+        double time = seconds() - start;
+
+        for (int i = 0; i < moves.count; ++i) {
+                glt_move16_to_string(moves.moves[i], str);
+                printf("%s: %llu\n", str, (unsigned long long)counts[i]);
+        }
+
+        printf("\nmoves %d\nnodes %llu\ntime  %.3fs\nnps   %.0f\n", moves.count, (unsigned long long)nodes,
+                time, time > 0 ? (double)nodes / time : 0.0);
+}
+
+int main(int argc, char const *argv[])
+{
+        if (argc >= 3 && strcmp(argv[1], "divide") == 0) {
+                run_divide(atoi(argv[2]), argc >= 4 ? argv[3] : START_FEN);
+                return 0;
+        }
+
+        if (argc >= 3 && strcmp(argv[1], "suite") == 0) {
+                return run_suite(atoi(argv[2]), 0) != 0;
+        }
+
+        if (argc >= 3 && strcmp(argv[1], "parallel") == 0) {
+                return run_suite(atoi(argv[2]), argc >= 4 ? atoi(argv[3]) : glt_thread_count()) != 0;
+        }
+
+        return run_suite(4, 0) != 0;
+}
@@ -0,0 +1,204 @@
+/**
+        PGN reader test for glt_chess.h
+
+        cc -O2 -o glt_chess_pgn tests/glt_chess_pgn.c
+        cc -O2 -DGLT_CHESS_NO_MMAP -o glt_chess_pgn tests/glt_chess_pgn.c    reads the file without mapping it
+        ./glt_chess_pgn [file]      file is the scratch file, glt_chess_pgn.pgn by default
+
+        Returns non zero if any of the checks fails
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#define GLT_CHESS_IMPLEMENTATION
+#include "../glt_chess.h"
+
+/* comments, nested variations, NAGs, annotations, a setup position, crlf lines and different results */
+static const char pgn[] =
+        "[Event \"Test, with \\\"quotes\\\"\"]\n"
+        "[Site \"?\"]\n"
+        "[White \"Alpha\"]\n"
+        "[Black \"Beta\"]\n"
+        "[Result \"*\"]\n"
+        "\n"
+        "1. e4 {best by test} e5 2. Nf3 (2. f4 exf4 (2... d5 {the counter gambit}) 3. Nf3) 2... Nc6\n"
+        "3. Bb5!? $1 a6 ; a comment to the end of the line 4. h4\n"
+        "4. Ba4 Nf6 5. O-O Be7 *\n"
+        "\n"
+        "[Event \"Scholar\"]\n"
+        "[Result \"1-0\"]\n"
+        "\n"
+        "1.e4 e5 2.Qh5 Nc6 3.Bc4 Nf6 4.Qxf7# 1-0\n"
+        "\n"
+        "\r\n"
+        "[Event \"Setup\"]\r\n"
+        "[SetUp \"1\"]\r\n"
+        "[FEN \"4k3/1P6/8/3pP3/8/8/8/4K3 w - d6 0 1\"]\r\n"
+        "[Result \"1/2-1/2\"]\r\n"
+        "\r\n"
+        "1. exd6 Kd7 2. b8=Q Kc6 1/2-1/2\r\n";
+
+typedef struct {
+        const char* event;
+        int moves;
+        const char* fen;        /* after the last move */
+} pgn_expected;
+
+static const pgn_expected games[] = {
+        { "Test, with \\\"quotes\\\"", 10, "r1bqk2r/1pppbppp/p1n2n2/4p3/B3P3/5N2/PPPP1PPP/RNBQ1RK1 w kq - 4 6" },
+        { "Scholar", 7, "r1bqkb1r/pppp1Qpp/2n2n2/4p3/2B1P3/8/PPPP1PPP/RNB1K1NR b KQkq - 0 4" },
+        { "Setup", 4, "1Q6/8/2kP4/8/8/8/8/4K3 w - - 1 3" },
+};
+
+#define GAME_COUNT (int)(sizeof(games) / sizeof(games[0]))
+
+static int failed = 0;
+
+static void check(int ok, const char* what)
+{
+        printf("%-48s %s\n", what, ok ? "ok" : "FAIL");
+        if (!ok) failed++;
+}
+
+static int view_is(glt_view view, const char* str)
+{
+        return view.length == strlen(str) && memcmp(view.data, str, view.length) == 0;
+}
+
+static int count_moves(glt_chess_board* board, glt_move16 move, void* user)
+{
+        (void)board;
+        (void)move;
+        (*(int*)user)++;
+        return 1;
+}
+
+/* Reads all the games of the text, returns the number of games that match the expected ones */
+static int read_games(const char* data, size_t size, int first)
+{
+        glt_pgn_reader reader;
+        glt_pgn_game game;
+        int matching = 0;
+
+        glt_pgn_reader_init(&reader, data, size);
+
+        for (int i = first; glt_pgn_next_game(&reader, &game); ++i)
+        {
+                glt_chess_board board;
+                glt_view event;
+                char fen[GLT_MAX_FEN_LENGTH];
+                int callbacks = 0;
+
+                if (i >= GAME_COUNT) return -1;
+                if (!glt_pgn_find_tag(&game, "Event", &event) || !view_is(event, games[i].event)) continue;
+
+                glt_initilize_board(&board);
+                int moves = glt_pgn_play(&game, &board, count_moves, &callbacks);
+                glt_get_fen_from_board(&board, fen, sizeof(fen));
+
+                if (moves == games[i].moves && callbacks == moves && strcmp(fen, games[i].fen) == 0) matching++;
+                else printf("game %d: %d moves, %s\n", i + 1, moves, fen);
+        }
+        return matching;
+}
+
+int main(int argc, char const *argv[])
+{
+        const char* path = argc >= 2 ? argv[1] : "glt_chess_pgn.pgn";
+        size_t size = sizeof(pgn) - 1;
+        glt_pgn_reader reader;
+        glt_pgn_game game;
+
+        check(read_games(pgn, size, 0) == GAME_COUNT, "play every game");
+
+        /* the tags and moves of the first game */
+        glt_pgn_reader_init(&reader, pgn, size);
+        glt_pgn_next_game(&reader, &game);
+        {
+                static const char* names[] = { "Event", "Site", "White", "Black", "Result" };
+                static const char* sans[] = { "e4", "e5", "Nf3", "Nc6", "Bb5!?", "a6", "Ba4", "Nf6", "O-O", "Be7" };
+                glt_view cursor = game.tags;
+                glt_view value, san;
+                glt_pgn_tag tag;
+                int tags = 0, moves = 0;
+
+                while (glt_pgn_next_tag(&cursor, &tag)) {
+                        if (tags < 5 && view_is(tag.name, names[tags])) tags++;
+                }
+                check(tags == 5, "tags of the first game");
+                check(glt_pgn_find_tag(&game, "White", &value) && view_is(value, "Alpha"), "find a tag");
+                check(!glt_pgn_find_tag(&game, "FEN", &value), "find a tag the game doesn't have");
+
+                cursor = game.movetext;
+                while (glt_pgn_next_san(&cursor, &san)) {
+                        if (moves < 10 && view_is(san, sans[moves])) moves++;
+                        else moves = -100;
+                }
+                check(moves == 10, "moves of the first game skip the rest");
+        }
+
+        /* every split has to start at a game so the parts read the same games */
+        for (int parts = 1; parts <= 5; ++parts)
+        {
+                size_t offsets[6];
+                int matching = 0, first = 0;
+                char what[64];
+
+                glt_pgn_split(pgn, size, parts, offsets);
+
+                for (int i = 0; i < parts; ++i)
+                {
+                        glt_pgn_reader_init(&reader, pgn + offsets[i], offsets[i + 1] - offsets[i]);
+                        int count = 0;
+                        while (glt_pgn_next_game(&reader, &game)) count++;
+
+                        matching += read_games(pgn + offsets[i], offsets[i + 1] - offsets[i], first);
+                        first += count;
+                }
+
+                snprintf(what, sizeof(what), "split in %d parts", parts);
+                check(offsets[0] == 0 && offsets[parts] == size && matching == GAME_COUNT, what);
+        }
+
+        /* text that ends in a ; comment without a newline */
+        {
+                static const char* last_comments[] = { "[Event \"End\"]\n\n1. e4 e5 ; the end", "[Event \"End\"]\n\n1. e4 e5 ;" };
+                int ok = 1;
+
+                for (int i = 0; i < 2; ++i) {
+                        glt_chess_board board;
+                        int games_read = 0, moves = 0;
+
+                        glt_pgn_reader_init(&reader, last_comments[i], strlen(last_comments[i]));
+                        while (games_read < 2 && glt_pgn_next_game(&reader, &game)) {
+                                glt_initilize_board(&board);
+                                moves = glt_pgn_play(&game, &board, NULL, NULL);
+                                games_read++;
+                        }
+                        ok &= games_read == 1 && moves == 2;
+                }
+                check(ok, "comment at the end of the text");
+        }
+
+        /* the same games from a file */
+        FILE* file = fopen(path, "wb");
+        int written = file && fwrite(pgn, 1, size, file) == size;
+        if (file) fclose(file);
+        check(written, "write the file");
+
+        glt_pgn_file pgn_file;
+        if (glt_pgn_open(&pgn_file, path))
+        {
+                check(pgn_file.size == size && memcmp(pgn_file.data, pgn, size) == 0, "open the file");
+                check(read_games(pgn_file.data, pgn_file.size, 0) == GAME_COUNT, "play every game of the file");
+                glt_pgn_close(&pgn_file);
+        }
+        else check(0, "open the file");
+
+        check(!glt_pgn_open(&pgn_file, "this file isn't there.pgn"), "open a file that isn't there");
+        remove(path);
+
+        printf("%s\n", failed ? "FAILED" : "all checks pass");
+        return failed != 0;
+}
@@ -0,0 +1,143 @@
+/**
+        SAN encoder and decoder test for glt_chess.h
+
+        cc -O2 -o glt_chess_san tests/glt_chess_san.c
+        ./glt_chess_san
+
+        Returns non zero if any of the checks fails
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#define GLT_CHESS_IMPLEMENTATION
+#include "../glt_chess.h"
+
+#define START_FEN "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
+
+typedef struct {
+        const char* fen;
+        const char* move;       /* coordinate notation */
+        const char* san;
+} san_case;
+
+/* every case is encoded and then decoded back */
+static const san_case cases[] = {
+        { START_FEN, "e2e4", "e4" },
+        { START_FEN, "g1f3", "Nf3" },
+        { "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1", "g8f6", "Nf6" },
+
+        /* disambiguation by file, by rank and by both */
+        { "4k3/8/8/8/8/8/8/1N2KN2 w - - 0 1", "b1d2", "Nbd2" },
+        { "4k3/8/8/8/8/8/8/1N2KN2 w - - 0 1", "f1d2", "Nfd2" },
+        { "4k3/8/8/8/8/8/8/1N2KN2 w - - 0 1", "f1e3", "Ne3" },
+        { "4k3/8/8/R7/8/8/8/R3K3 w - - 0 1", "a1a3", "R1a3" },
+        { "4k3/8/8/R7/8/8/8/R3K3 w - - 0 1", "a5a3", "R5a3" },
+        { "4k3/8/8/8/8/Q7/8/Q1Q1K3 w - - 0 1", "a1b2", "Qa1b2" },
+        { "4k3/8/8/8/8/Q7/8/Q1Q1K3 w - - 0 1", "c1b2", "Qcb2" },
+        { "4k3/8/8/8/8/Q7/8/Q1Q1K3 w - - 0 1", "a3b2", "Q3b2" },
+
+        /* a pinned piece doesn't make the move ambiguous */
+        { "4r1k1/8/8/8/8/8/4N3/1N2K3 w - - 0 1", "b1c3", "Nc3" },
+
+        /* captures and en passant */
+        { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", "e5f7", "Nxf7" },
+        { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", "d5e6", "dxe6" },
+        { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", "g2h3", "gxh3" },
+        { "rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 3", "e5d6", "exd6" },
+
+        /* promotions */
+        { "4k3/1P6/8/8/8/8/8/4K3 w - - 0 1", "b7b8q", "b8=Q+" },
+        { "4k3/1P6/8/8/8/8/8/4K3 w - - 0 1", "b7b8r", "b8=R+" },
+        { "4k3/1P6/8/8/8/8/8/4K3 w - - 0 1", "b7b8b", "b8=B" },
+        { "4k3/1P6/8/8/8/8/8/4K3 w - - 0 1", "b7b8n", "b8=N" },
+        { "r3k3/1P6/8/8/8/8/8/4K3 w - - 0 1", "b7a8q", "bxa8=Q+" },
+        { "4k3/8/8/8/8/8/6p1/4K2R b - - 0 1", "g2h1n", "gxh1=N" },
+
+        /* castling */
+        { "r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", "e1g1", "O-O" },
+        { "r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", "e1c1", "O-O-O" },
+        { "r3k2r/8/8/8/8/8/8/R3K2R b KQkq - 0 1", "e8c8", "O-O-O" },
+        { "5k2/8/8/8/8/8/8/4K2R w K - 0 1", "e1g1", "O-O+" },
+
+        /* check and mate */
+        { "4k3/8/8/8/8/8/8/R3K3 w - - 0 1", "a1a8", "Ra8+" },
+        { "r1bqkb1r/pppp1ppp/2n2n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR w KQkq - 4 4", "h5f7", "Qxf7#" },
+        { "6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1", "a1a8", "Ra8#" },
+};
+
+typedef struct {
+        const char* fen;
+        const char* san;
+        const char* move;       /* coordinate notation, NULL if the san has to be turned down */
+} decode_case;
+
+/* only decoded, the san is not what the encoder writes */
+static const decode_case decode_cases[] = {
+        { START_FEN, "Nf3!", "g1f3" },
+        { START_FEN, "e4!?", "e2e4" },
+        { "4k3/8/8/8/8/8/8/1N2KN2 w - - 0 1", "Nb1d2", "b1d2" },
+        { START_FEN, "e5", NULL },
+        { START_FEN, "xe4", NULL },
+        { START_FEN, "Qh5", NULL },
+        { START_FEN, "O-O", NULL },
+        { START_FEN, "", NULL },
+        { "4k3/8/8/8/8/8/8/1N2KN2 w - - 0 1", "Nd2", NULL },
+        { "4k3/1P6/8/8/8/8/8/4K3 w - - 0 1", "b8=K", NULL },
+};
+
+static int failed = 0;
+
+/* The legal move of the board in coordinate notation, GLT_MOVE16_NONE if there is none */
+static glt_move16 find_move(glt_chess_board* board, const char* str)
+{
+        glt_move_list list;
+        char move_str[6];
+
+        glt_move_list_clear(&list);
+        glt_generate_legal_moves(board, &list);
+
+        for (int i = 0; i < list.count; ++i) {
+                glt_move16_to_string(list.moves[i], move_str);
+                if (strcmp(move_str, str) == 0) return list.moves[i];
+        }
+        return GLT_MOVE16_NONE;
+}
+
+int main(void)
+{
+        for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+        {
+                const san_case* c = &cases[i];
+                glt_chess_board board;
+                char san[8] = "";
+
+                glt_set_board_from_fen(&board, c->fen);
+                u64 hash = board.hash;
+                glt_move16 move = find_move(&board, c->move);
+
+                if (move != GLT_MOVE16_NONE) glt_move16_to_san(&board, move, san);
+                glt_move16 decoded = glt_move16_from_san(&board, c->san, strlen(c->san));
+
+                int ok = move != GLT_MOVE16_NONE && strcmp(san, c->san) == 0 && decoded == move && board.hash == hash;
+                printf("%-6s %-8s %-8s %s\n", c->move, c->san, san, ok ? "ok" : "FAIL");
+                if (!ok) failed++;
+        }
+
+        for (size_t i = 0; i < sizeof(decode_cases) / sizeof(decode_cases[0]); ++i)
+        {
+                const decode_case* c = &decode_cases[i];
+                glt_chess_board board;
+
+                glt_set_board_from_fen(&board, c->fen);
+                glt_move16 expected = c->move ? find_move(&board, c->move) : GLT_MOVE16_NONE;
+                glt_move16 decoded = glt_move16_from_san(&board, c->san, strlen(c->san));
+
+                int ok = decoded == expected && (c->move == NULL || expected != GLT_MOVE16_NONE);
+                printf("%-6s %-8s %-8s %s\n", c->move ? c->move : "none", c->san, "", ok ? "ok" : "FAIL");
+                if (!ok) failed++;
+        }
+
+        printf("%s\n", failed ? "FAILED" : "all checks pass");
+        return failed != 0;
+}
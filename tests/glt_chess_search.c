@@ -0,0 +1,91 @@
+/**
+        Search regression test for glt_chess.h
+
+        cc -O2 -pthread -o glt_chess_search tests/glt_chess_search.c
+        ./glt_chess_search
+
+        Returns non zero if any of the checks fails
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* fill what the library allocates with garbage so nothing gets by on fresh pages being 0 */
+static void* test_malloc(size_t size)
+{
+        void* memory = malloc(size);
+        if (memory) memset(memory, 0xa5, size);
+        return memory;
+}
+
+#define GLT_malloc(x) (test_malloc(x))
+#define GLT_free(x) (free(x))
+#define GLT_CHESS_IMPLEMENTATION
+#include "../glt_chess.h"
+
+typedef struct {
+        const char* name;
+        const char* fen;
+        const char* best_move; /* NULL if any mating move will do */
+        int score;             /* 1 mating, -1 mated, 0 stalemate, there is no best move when it's not 1 */
+} search_position;
+
+static const search_position positions[] = {
+        { "stalemate",  "7k/5Q2/6K1/8/8/8/8/8 b - - 0 1", NULL, 0 },
+        { "checkmated", "7k/6Q1/6K1/8/8/8/8/8 b - - 0 1", NULL, -1 },
+        { "mate in 1",  "7k/8/6K1/8/8/8/8/5Q2 w - - 0 1", "f1f8", 1 },
+        { "back rank",  "6k1/5ppp/8/8/8/8/8/R3R1K1 w - - 0 1", NULL, 1 },
+};
+
+static int check_position(const search_position* position, int threads, glt_tt* tt)
+{
+        glt_chess_board board;
+        glt_search_limits limits;
+        glt_search_result result;
+        char str[6] = "none";
+        int failed = 0;
+
+        glt_set_board_from_fen(&board, position->fen);
+        u64 hash = board.hash;
+
+        memset(&limits, 0, sizeof(limits));
+        limits.depth = 6;
+        limits.threads = threads;
+        limits.tt = tt;
+        if (tt) glt_tt_clear(tt);
+
+        glt_search(&board, &limits, &result);
+
+        if (result.best_move != GLT_MOVE16_NONE) glt_move16_to_string(result.best_move, str);
+
+        if ((position->score == 1) != (result.best_move != GLT_MOVE16_NONE)) failed = 1;
+        if (position->best_move != NULL && strcmp(str, position->best_move) != 0) failed = 1;
+        if (position->score == 0 && result.score != 0) failed = 1;
+        if (position->score == 1 && result.score <= GLT_MATE_SCORE - GLT_MAX_PLY) failed = 1;
+        if (position->score == -1 && result.score >= -GLT_MATE_SCORE + GLT_MAX_PLY) failed = 1;
+        if (board.hash != hash) failed = 1;
+
+        printf("%-12s threads %d %s best %s score %d\n", position->name, threads, failed ? "FAIL" : "ok  ", str, result.score);
+        return failed;
+}
+
+int main(void)
+{
+        glt_tt tt;
+        int failed = 0;
+
+        glt_tt_create(&tt, 1);
+
+        for (size_t i = 0; i < sizeof(positions) / sizeof(positions[0]); ++i)
+        {
+                failed += check_position(&positions[i], 1, NULL);
+                failed += check_position(&positions[i], 1, &tt);
+                failed += check_position(&positions[i], 2, &tt);
+        }
+
+        glt_tt_destroy(&tt);
+
+        printf("%s\n", failed ? "FAILED" : "all checks pass");
+        return failed != 0;
+}